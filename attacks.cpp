@@ -0,0 +1,208 @@
+#include "attacks.h"
+
+#include "square.h"
+
+namespace {
+
+constexpr Bitboard notAColumn = 9187201950435737471ULL;
+constexpr Bitboard notABColumn = 4557430888798830399ULL;
+constexpr Bitboard notHColumn = 18374403900871474942ULL;
+constexpr Bitboard notGHColumn = 18229723555195321596ULL;
+
+constexpr Bitboard knightAttacksFrom(Bitboard square) {
+    return ((square >> 6 & notGHColumn) |
+            (square >> 10 & notABColumn) |
+            (square >> 15 & notHColumn) |
+            (square >> 17 & notAColumn) |
+            (square << 6 & notABColumn) |
+            (square << 10 & notGHColumn) |
+            (square << 15 & notAColumn) |
+            (square << 17 & notHColumn));
+}
+
+constexpr Bitboard kingAttacksFrom(Bitboard square) {
+    return ((square >> 9 & notAColumn) |
+            (square >> 8) |
+            (square >> 7 & notHColumn) |
+            (square >> 1 & notAColumn) |
+            (square << 1 & notHColumn) |
+            (square << 7 & notAColumn) |
+            (square << 8) |
+            (square << 9 & notHColumn));
+}
+
+constexpr Bitboard whitePawnAttacksFrom(Bitboard square) {
+    return ((square << 7 & notAColumn) | (square << 9 & notHColumn));
+}
+
+constexpr Bitboard blackPawnAttacksFrom(Bitboard square) {
+    return ((square >> 9 & notAColumn) | (square >> 7 & notHColumn));
+}
+
+constexpr Bitboard whitePawnPushesFrom(Bitboard square) {
+    return square << 8;
+}
+
+constexpr Bitboard blackPawnPushesFrom(Bitboard square) {
+    return square >> 8;
+}
+
+template <Bitboard (*attacksFrom)(Bitboard)>
+constexpr Attacks::SquareTable makeTable() {
+    Attacks::SquareTable table = {};
+    for (int square = 0; square < 64; ++square) {
+        table.squares[square] = attacksFrom(1ULL << square);
+    }
+    return table;
+}
+
+constexpr Bitboard rookMagicNumbers[64] = {
+    0x1080004008801020ULL, 0x0840092002C03000ULL, 0x1900200010400900ULL, 0x0880100008000480ULL,
+    0x4200100420080200ULL, 0x8100020100080400ULL, 0x0200040110886200ULL, 0x0200008040220411ULL,
+    0x0404800084400220ULL, 0x0000401000402000ULL, 0x0086001081220440ULL, 0x0408800800100280ULL,
+    0x000A001201040820ULL, 0x8848800200840080ULL, 0x4001000100040200ULL, 0x0442000102105084ULL,
+    0x9080010020804100ULL, 0x0040404000201009ULL, 0x0000808010002009ULL, 0x2200090021D00100ULL,
+    0x0008008008040080ULL, 0x0004004002010040ULL, 0x0011040008015042ULL, 0x00000A0001768104ULL,
+    0x0000800080204009ULL, 0x2010004140002001ULL, 0x9800200280100080ULL, 0x1000100080080080ULL,
+    0x0442000A00049020ULL, 0x2100040080020080ULL, 0x0800120400900148ULL, 0x0010040A00128541ULL,
+    0x2800804000800030ULL, 0x1010002000400041ULL, 0x4000200011004100ULL, 0x0610008410800800ULL,
+    0x0400802402800800ULL, 0xC100020080800400ULL, 0x0002000802000401ULL, 0x0182085882000401ULL,
+    0x0220204000808000ULL, 0x2860100040024022ULL, 0x0001002004110040ULL, 0x99101042000A0020ULL,
+    0x0004080004008080ULL, 0x0010040002008080ULL, 0x2012004881020004ULL, 0x8300842444820011ULL,
+    0x0088403882010200ULL, 0x0820400080210100ULL, 0x0110910040A00300ULL, 0x0801100280080480ULL,
+    0x0242009008200600ULL, 0x1002000489500200ULL, 0x0040800200010080ULL, 0x0091800041000080ULL,
+    0x0000209300488001ULL, 0x04C1002414824001ULL, 0x020020000B001041ULL, 0x7000100004200901ULL,
+    0x8002002004100802ULL, 0x30010002084C0007ULL, 0x0888221800813004ULL, 0x4000002840840112ULL
+};
+
+constexpr Bitboard bishopMagicNumbers[64] = {
+    0xA010041108003100ULL, 0x006082020A002900ULL, 0x6810010619200000ULL, 0x08281A0520000408ULL,
+    0x0001104001000400ULL, 0x0018901008048400ULL, 0x00040A0210245280ULL, 0x000200210808A402ULL,
+    0x9140048410821200ULL, 0x0800091010820041ULL, 0x20504804832202C0ULL, 0x0100091401081000ULL,
+    0x8021011140000012ULL, 0x0810020804450400ULL, 0x208B0542109008A2ULL, 0x0080084A08040204ULL,
+    0x0040E2A80811244CULL, 0x2505022008008108ULL, 0x0430220100420040ULL, 0x010A040420220040ULL,
+    0x1105000290400000ULL, 0x0093001200822120ULL, 0x4000A62048043004ULL, 0x280120048A015004ULL,
+    0x006090002A020814ULL, 0x44042000240800D0ULL, 0x01102800040A4400ULL, 0x1004080080220040ULL,
+    0x0001001011004024ULL, 0x0010044000805040ULL, 0x0914041200820100ULL, 0x0004821012821480ULL,
+    0x0024040500C05021ULL, 0x0088611002080200ULL, 0x0116080A00040020ULL, 0x4000020080080080ULL,
+    0x2450450140840040ULL, 0x0000880201484100ULL, 0x0222020404020092ULL, 0x8081110600002E00ULL,
+    0x2842101105000801ULL, 0x1100809008001025ULL, 0x00020202221C0400ULL, 0x0422014022009020ULL,
+    0x0210046102100C00ULL, 0xC004008082029102ULL, 0x00AA461801101200ULL, 0x0404080080201108ULL,
+    0x020542108C205002ULL, 0x0410544804100100ULL, 0x0040910841100000ULL, 0x0400200042021100ULL,
+    0x00004204850400C0ULL, 0x0200100410A42102ULL, 0x1040020801210102ULL, 0x0805040410420000ULL,
+    0x2884804130100200ULL, 0x800C262201242000ULL, 0x1058000194108800ULL, 0x0014221054420204ULL,
+    0x0104000012A02200ULL, 0x0200881003300100ULL, 0x0140400202840100ULL, 0x0402020801010201ULL
+};
+
+constexpr int rookDirections[4][2] = { { 0, 1 }, { 1, 0 }, { 0, -1 }, { -1, 0 } };
+constexpr int bishopDirections[4][2] = { { 1, 1 }, { 1, -1 }, { -1, -1 }, { -1, 1 } };
+
+// Total size of the tables is the sum over squares of 2^(relevant bits)
+Bitboard rookTable[102400];
+Bitboard bishopTable[5248];
+
+/*
+ * Walk each direction one square at a time, stopping after the first
+ * occupied square. Only used to fill the tables.
+ * If excludeEdges is set, the last square before the edge of the board is
+ * left out, giving the mask of squares whose occupancy matters.
+ */
+Bitboard slidingAttacks(int square, Bitboard occupancy, int const (&directions)[4][2], bool excludeEdges) {
+    Bitboard result = 0;
+    for (auto const &direction : directions) {
+        int current = square;
+        while (true) {
+            const int next = Square::getInDirection(current, direction[0], direction[1]);
+            if (next == -1) {
+                break;
+            }
+            if (excludeEdges && Square::getInDirection(next, direction[0], direction[1]) == -1) {
+                break;
+            }
+            current = next;
+            result |= Square::getMask(current);
+            if (occupancy & Square::getMask(current)) {
+                break;
+            }
+        }
+    }
+
+    return result;
+}
+
+void initMagics(Attacks::Magic (&magics)[64], Bitboard const (&magicNumbers)[64], Bitboard *table, int const (&directions)[4][2]) {
+    Bitboard *next = table;
+    for (int square = 0; square < 64; ++square) {
+        Attacks::Magic &m = magics[square];
+        m.mask = slidingAttacks(square, 0, directions, true);
+        m.magic = magicNumbers[square];
+        m.shift = 64 - Square::getBitCount(m.mask);
+        m.attacks = next;
+        // Enumerate every subset of the mask (Carry-Rippler)
+        Bitboard occupancy = 0;
+        do {
+            m.attacks[m.getIndex(occupancy)] = slidingAttacks(square, occupancy, directions, false);
+            occupancy = (occupancy - m.mask) & m.mask;
+        } while (occupancy);
+        next += 1ULL << (64 - m.shift);
+    }
+}
+
+void initLines() {
+    for (int a = 0; a < 64; ++a) {
+        for (int b = 0; b < 64; ++b) {
+            Attacks::betweenTable[a][b] = 0;
+            Attacks::lineTable[a][b] = 0;
+            if (a == b) {
+                continue;
+            }
+            const Bitboard aMask = Square::getMask(a);
+            const Bitboard bMask = Square::getMask(b);
+            if (Attacks::getRookAttacks(a, 0) & bMask) {
+                Attacks::betweenTable[a][b] = Attacks::getRookAttacks(a, bMask) & Attacks::getRookAttacks(b, aMask);
+                Attacks::lineTable[a][b] = (Attacks::getRookAttacks(a, 0) & Attacks::getRookAttacks(b, 0)) | aMask | bMask;
+            } else if (Attacks::getBishopAttacks(a, 0) & bMask) {
+                Attacks::betweenTable[a][b] = Attacks::getBishopAttacks(a, bMask) & Attacks::getBishopAttacks(b, aMask);
+                Attacks::lineTable[a][b] = (Attacks::getBishopAttacks(a, 0) & Attacks::getBishopAttacks(b, 0)) | aMask | bMask;
+            }
+        }
+    }
+}
+
+struct Initialiser {
+    Initialiser() {
+        // The table layout depends on whether PEXT is used for indexing
+        Cpu::init();
+        initMagics(Attacks::rookMagics, rookMagicNumbers, rookTable, rookDirections);
+        initMagics(Attacks::bishopMagics, bishopMagicNumbers, bishopTable, bishopDirections);
+        initLines();
+    }
+};
+
+}
+
+constexpr Attacks::SquareTable Attacks::knightTable = makeTable<knightAttacksFrom>();
+constexpr Attacks::SquareTable Attacks::kingTable = makeTable<kingAttacksFrom>();
+
+constexpr Attacks::SquareTable Attacks::pawnAttackTables[2] = {
+    makeTable<whitePawnAttacksFrom>(),
+    makeTable<blackPawnAttacksFrom>()
+};
+
+constexpr Attacks::SquareTable Attacks::pawnPushTables[2] = {
+    makeTable<whitePawnPushesFrom>(),
+    makeTable<blackPawnPushesFrom>()
+};
+
+Attacks::Magic Attacks::rookMagics[64];
+Attacks::Magic Attacks::bishopMagics[64];
+
+Bitboard Attacks::betweenTable[64][64];
+Bitboard Attacks::lineTable[64][64];
+
+namespace {
+
+// Defined after the magic arrays so that they are filled in declaration order
+const Initialiser initialiser;
+
+}
\ No newline at end of file
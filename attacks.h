@@ -0,0 +1,98 @@
+/*
+ * Precomputed attack sets
+ * Knight, king and pawn tables are generated at compile time.
+ * Sliding pieces use magic bitboards: the occupancy of the squares relevant
+ * to a slider is multiplied by a per-square magic number, and the top bits of
+ * the product index a table holding the attack set for that occupancy.
+ * When BMI2 is available, PEXT extracts the relevant occupancy bits directly
+ * and is used as the index instead
+ */
+
+#ifndef ATTACKS_H
+#define ATTACKS_H
+
+#include "cpu.h"
+#include "side.h"
+
+#include <cstdint>
+
+typedef std::uint64_t Bitboard;
+
+namespace Attacks {
+
+struct SquareTable {
+    Bitboard squares[64];
+};
+
+extern const SquareTable knightTable;
+extern const SquareTable kingTable;
+
+/* Indexed by side, white first */
+extern const SquareTable pawnAttackTables[2];
+extern const SquareTable pawnPushTables[2];
+
+struct Magic {
+    Bitboard mask; // Relevant occupancy, excluding the board edge
+    Bitboard magic;
+    Bitboard *attacks; // Start of this square's slice of the attack table
+    unsigned int shift;
+
+    unsigned int getIndex(Bitboard occupancy) const {
+        if (Cpu::hasBmi2) {
+            return static_cast<unsigned int>(Cpu::pext(occupancy, mask));
+        }
+        return static_cast<unsigned int>(((occupancy & mask) * magic) >> shift);
+    }
+};
+
+extern Magic rookMagics[64];
+extern Magic bishopMagics[64];
+
+extern Bitboard betweenTable[64][64];
+extern Bitboard lineTable[64][64];
+
+/* Squares strictly between a and b, or 0 if they are not in line */
+inline Bitboard getBetween(int a, int b) {
+    return betweenTable[a][b];
+}
+
+/* Full line through a and b, edge to edge, or 0 if they are not in line */
+inline Bitboard getLine(int a, int b) {
+    return lineTable[a][b];
+}
+
+inline Bitboard getKnightAttacks(int square) {
+    return knightTable.squares[square];
+}
+
+inline Bitboard getKingAttacks(int square) {
+    return kingTable.squares[square];
+}
+
+/* Squares a pawn of side on square captures on */
+inline Bitboard getPawnAttacks(int square, Side side) {
+    return pawnAttackTables[side == Side::White ? 0 : 1].squares[square];
+}
+
+/* Square a pawn of side on square moves to when advancing one square */
+inline Bitboard getPawnPushes(int square, Side side) {
+    return pawnPushTables[side == Side::White ? 0 : 1].squares[square];
+}
+
+inline Bitboard getRookAttacks(int square, Bitboard occupancy) {
+    Magic const &m = rookMagics[square];
+    return m.attacks[m.getIndex(occupancy)];
+}
+
+inline Bitboard getBishopAttacks(int square, Bitboard occupancy) {
+    Magic const &m = bishopMagics[square];
+    return m.attacks[m.getIndex(occupancy)];
+}
+
+inline Bitboard getQueenAttacks(int square, Bitboard occupancy) {
+    return getRookAttacks(square, occupancy) | getBishopAttacks(square, occupancy);
+}
+
+} // namespace Attacks
+
+#endif
\ No newline at end of file
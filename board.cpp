@@ -1,9 +1,12 @@
 #include "board.h"
 
+#include "attacks.h"
 #include "column.h"
 #include "piece.h"
 #include "piecetype.h"
+#include "psqt.h"
 #include "square.h"
+#include "zobrist.h"
 
 #include <algorithm>
 #include <bitset>
@@ -11,6 +14,21 @@
 #include <string>
 #include <utility>
 
+namespace {
+
+// Piece type bitboards, indexed by piece type
+Bitboard Board::*const pieceBitboards[7] = {
+    nullptr,
+    &Board::pawns,
+    &Board::knights,
+    &Board::bishops,
+    &Board::rooks,
+    &Board::queens,
+    &Board::kings
+};
+
+}
+
 Board::Board() {
     whites = 0;
     blacks = 0;
@@ -20,17 +38,14 @@ Board::Board() {
     rooks = 0;
     queens = 0;
     kings = 0;
+    mailbox.fill(Piece::None);
+    hash = 0;
+    pawnHash = 0;
+    psqtScore = { 0, 0 };
+    phase = 0;
 }
 
-Board::Board(std::string const &fenString) {
-    whites = 0;
-    blacks = 0;
-    pawns = 0;
-    knights = 0;
-    bishops = 0;
-    rooks = 0;
-    queens = 0;
-    kings = 0;
+Board::Board(std::string const &fenString) : Board() {
     int x = 0;
     int y = 8;
     for (int i = 0; i < fenString.length(); ++i) {
@@ -53,26 +68,8 @@ Board::Board(std::string const &fenString) {
     }
 }
 
-Board::Board(Board const &old) {
-    whites = old.whites;
-    blacks = old.blacks;
-    pawns = old.pawns;
-    knights = old.knights;
-    bishops = old.bishops;
-    rooks = old.rooks;
-    queens = old.queens;
-    kings = old.kings;
-}
-
 void Board::setToStartPosition() {
-    whites = 65535ULL;
-    blacks = 18446462598732840960ULL;
-    pawns = 71776119061282560ULL;
-    knights = 4755801206503243842ULL;
-    bishops = 2594073385365405732ULL;
-    rooks = 9295429630892703873ULL;
-    queens = 576460752303423496ULL;
-    kings = 1152921504606846992ULL;
+    *this = Board("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR");
 }
 
 std::string Board::toString() const {
@@ -96,45 +93,6 @@ void Board::print() const {
     std::cout << Board::toString() << std::endl;
 }
 
-int Board::at(int square) const {
-    const Bitboard squareMask = Board::getMask(square);
-    if (whites & squareMask) {
-        if (pawns & squareMask) {
-            return PieceType::Pawn;
-        } else if (knights & squareMask) {
-            return PieceType::Knight;
-        } else if (bishops & squareMask) {
-            return PieceType::Bishop;
-        } else if (rooks & squareMask) {
-            return PieceType::Rook;
-        } else if (queens & squareMask) {
-            return PieceType::Queen;
-        } else if (kings & squareMask) {
-            return PieceType::King;
-        }
-    } else if (blacks & squareMask) {
-        if (pawns & squareMask) {
-            return -PieceType::Pawn;
-        } else if (knights & squareMask) {
-            return -PieceType::Knight;
-        } else if (bishops & squareMask) {
-            return -PieceType::Bishop;
-        } else if (rooks & squareMask) {
-            return -PieceType::Rook;
-        } else if (queens & squareMask) {
-            return -PieceType::Queen;
-        } else if (kings & squareMask) {
-            return -PieceType::King;
-        }
-    } else {
-        return Piece::None;
-    }
-}
-
-bool Board::isEmpty(int square) const {
-    return !((whites | blacks) & Board::getMask(square));
-}
-
 void Board::addPiece(int square, int piece) {
     const Bitboard squareMask = Board::getMask(square);
     if (Piece::getSide(piece) == Side::White) {
@@ -142,253 +100,80 @@ void Board::addPiece(int square, int piece) {
     } else {
         blacks |= squareMask;
     }
-    switch (Piece::getType(piece)) {
-        case PieceType::Pawn:
-            pawns |= squareMask;
-            break;
-
-        case PieceType::Knight:
-            knights |= squareMask;
-            break;
-
-        case PieceType::Bishop:
-            bishops |= squareMask;
-            break;
-
-        case PieceType::Rook:
-            rooks |= squareMask;
-            break;
-
-        case PieceType::Queen:
-            queens |= squareMask;
-            break;
-
-        case PieceType::King:
-            kings |= squareMask;
-            break;
+    this->*pieceBitboards[Piece::getType(piece)] |= squareMask;
+    mailbox[square] = piece;
+    hash ^= Zobrist::getPieceKey(piece, square);
+    if (Piece::getType(piece) == PieceType::Pawn) {
+        pawnHash ^= Zobrist::getPieceKey(piece, square);
     }
+    psqtScore += Psqt::get(piece, square);
+    phase += Psqt::getPhase(Piece::getType(piece));
 }
 
 void Board::deletePiece(int square) {
     const Bitboard squareMask = Board::getMask(square);
-    if (whites & squareMask) {
+    const int piece = mailbox[square];
+    if (piece > 0) {
         whites ^= squareMask;
     } else {
         blacks ^= squareMask;
     }
-    if (pawns & squareMask) {
-        pawns ^= squareMask;
-    } else if (knights & squareMask) {
-        knights ^= squareMask;
-    } else if (bishops & squareMask) {
-        bishops ^= squareMask;
-    } else if (rooks & squareMask) {
-        rooks ^= squareMask;
-    } else if (queens & squareMask) {
-        queens ^= squareMask;
-    } else if (kings & squareMask) {
-        kings ^= squareMask;
+    this->*pieceBitboards[Piece::getType(piece)] ^= squareMask;
+    mailbox[square] = Piece::None;
+    hash ^= Zobrist::getPieceKey(piece, square);
+    if (Piece::getType(piece) == PieceType::Pawn) {
+        pawnHash ^= Zobrist::getPieceKey(piece, square);
     }
+    psqtScore -= Psqt::get(piece, square);
+    phase -= Psqt::getPhase(Piece::getType(piece));
 }
 
 void Board::movePiece(int origin, int destination) {
     // Assumes there exists a piece at origin
-    const Bitboard originMask = Board::getMask(origin);
-    const Bitboard destinationMask = Board::getMask(destination);
-    const Bitboard movementMask = originMask ^ destinationMask;
-    if (whites & originMask) {
+    const Bitboard movementMask = Board::getMask(origin) ^ Board::getMask(destination);
+    const int piece = mailbox[origin];
+    if (piece > 0) {
         whites ^= movementMask;
     } else {
         blacks ^= movementMask;
     }
-
-    if (pawns & originMask) {
-        pawns ^= movementMask;
-    } else if (knights & originMask) {
-        knights ^= movementMask;
-    } else if (bishops & originMask) {
-        bishops ^= movementMask;
-    } else if (rooks & originMask) {
-        rooks ^= movementMask;
-    } else if (queens & originMask) {
-        queens ^= movementMask;
-    } else if (kings & originMask) {
-        kings ^= movementMask;
+    this->*pieceBitboards[Piece::getType(piece)] ^= movementMask;
+    mailbox[destination] = piece;
+    mailbox[origin] = Piece::None;
+    hash ^= Zobrist::getPieceKey(piece, origin) ^ Zobrist::getPieceKey(piece, destination);
+    if (Piece::getType(piece) == PieceType::Pawn) {
+        pawnHash ^= Zobrist::getPieceKey(piece, origin) ^ Zobrist::getPieceKey(piece, destination);
     }
+    psqtScore -= Psqt::get(piece, origin);
+    psqtScore += Psqt::get(piece, destination);
 }
 
-bool Board::isUnderAttack(int square, Side side) const {
-    const Bitboard oppSide = (side == Side::White) ? blacks : whites;
-    // Check all knight spots
-    if (isAttackedByKnight(square, side)) {
-        return true;
-    }
-    // Check the two possible squares that an enemy pawn could be checking from
-    const Bitboard squareMask = Board::getMask(square);
-    Bitboard pawnLocationFirst;
-    Bitboard pawnLocationSecond;
-    if (side == Side::White) {
-        pawnLocationFirst = Square::getInDirection(squareMask, Direction::Northwest);
-        pawnLocationSecond = Square::getInDirection(squareMask, Direction::Northeast);
-    } else {
-        pawnLocationFirst = Square::getInDirection(squareMask, Direction::Southeast);
-        pawnLocationSecond = Square::getInDirection(squareMask, Direction::Southwest);
-    }
-    if ((pawnLocationFirst && pawns & pawnLocationFirst && oppSide & pawnLocationFirst) ||
-        (pawnLocationSecond && pawns & pawnLocationSecond && oppSide & pawnLocationSecond)) {
-        return true;
+std::uint64_t Board::computeHash() const {
+    std::uint64_t result = 0;
+    for (int square = 0; square < 64; ++square) {
+        result ^= Zobrist::getPieceKey(mailbox[square], square);
     }
 
-    // If any ray attacker exists in any corresponding direction, we are in check.
-    return (isAttackedInDirection(squareMask, side, Direction::North) ||
-            isAttackedInDirection(squareMask, side, Direction::Northeast) ||
-            isAttackedInDirection(squareMask, side, Direction::Northwest) ||
-            isAttackedInDirection(squareMask, side, Direction::South) ||
-            isAttackedInDirection(squareMask, side, Direction::Southeast) ||
-            isAttackedInDirection(squareMask, side, Direction::Southwest) ||
-            isAttackedInDirection(squareMask, side, Direction::East) ||
-            isAttackedInDirection(squareMask, side, Direction::West));
+    return result;
 }
 
-bool Board::isAttackedByKnight(int square, Side side) const {
-    const Bitboard oppSide = (side == Side::White) ? blacks : whites;
-
-    return (knights & oppSide & Square::getKnightAttacks(Board::getMask(square)));
+bool Board::isUnderAttack(int square, Side side) const {
+    return getAttackers(square, whites | blacks, side);
 }
 
 bool Board::wouldBeUnderAttack(int square, int origin, Side side) const {
-    // Check all knight spots
-    if (isAttackedByKnight(square, side)) {
-        return true;
-    }
-    const Bitboard squareMask = Board::getMask(square);
-    const Bitboard oppSide = (side == Side::White) ? blacks : whites;
-    if (Square::getKingAttacks(squareMask) & kings & oppSide) {
-        return true;
-    }
-    // Check the two possible squares that an enemy pawn could be checking from
-    Bitboard pawnLocationFirst;
-    Bitboard pawnLocationSecond;
-    if (side == Side::White) {
-        pawnLocationFirst = Square::getInDirection(squareMask, Direction::Northwest);
-        pawnLocationSecond = Square::getInDirection(squareMask, Direction::Northeast);
-    } else {
-        pawnLocationFirst = Square::getInDirection(squareMask, Direction::Southeast);
-        pawnLocationSecond = Square::getInDirection(squareMask, Direction::Southwest);
-    }
-    if ((pawnLocationFirst && pawns & pawnLocationFirst && oppSide & pawnLocationFirst) ||
-        (pawnLocationSecond && pawns & pawnLocationSecond && oppSide & pawnLocationSecond)) {
-        return true;
-    }
-    const Bitboard originMask = Square::getMask(origin);
-    // If any ray attacker exists in any corresponding direction, we are in check.
-    return (wouldBeAttackedInDirection(squareMask, originMask, side, Direction::North) ||
-            wouldBeAttackedInDirection(squareMask, originMask, side, Direction::Northeast) ||
-            wouldBeAttackedInDirection(squareMask, originMask, side, Direction::Northwest) ||
-            wouldBeAttackedInDirection(squareMask, originMask, side, Direction::South) ||
-            wouldBeAttackedInDirection(squareMask, originMask, side, Direction::Southeast) ||
-            wouldBeAttackedInDirection(squareMask, originMask, side, Direction::Southwest) ||
-            wouldBeAttackedInDirection(squareMask, originMask, side, Direction::East) ||
-            wouldBeAttackedInDirection(squareMask, originMask, side, Direction::West));
+    // The piece on origin no longer blocks any rays
+    return getAttackers(square, (whites | blacks) ^ Board::getMask(origin), side);
 }
 
-std::tuple<CheckType, int> Board::getInCheckStatus(Side side) const {
-    bool directAttacker = false;
-    int attackerSquare = -1;
+Bitboard Board::getAttackers(int square, Bitboard occupancy, Side side) const {
     const Bitboard oppSide = (side == Side::White) ? blacks : whites;
-    const Bitboard curSide = (side == Side::White) ? whites : blacks;
-    const Bitboard squareMask = kings & curSide;
-    // Check all knight spots
-    const Bitboard knightLocation = Square::getKnightAttacks(squareMask) & knights & oppSide;
-    if (knightLocation) {
-        attackerSquare = Square::getSetBit(knightLocation);
-        directAttacker = true;
-    } else {
-        // Check the two possible squares that an enemy pawn could be checking from
-        Bitboard pawnLocationFirst;
-        Bitboard pawnLocationSecond;
-        if (side == Side::White) {
-            pawnLocationFirst = Square::getInDirection(squareMask, Direction::Northwest);
-            pawnLocationSecond = Square::getInDirection(squareMask, Direction::Northeast);
-        } else {
-            pawnLocationFirst = Square::getInDirection(squareMask, Direction::Southeast);
-            pawnLocationSecond = Square::getInDirection(squareMask, Direction::Southwest);
-        }
-        if (pawnLocationFirst && pawns & pawnLocationFirst && oppSide & pawnLocationFirst) {
-            directAttacker = true;
-            attackerSquare = Square::getSetBit(pawnLocationFirst);
-        }
-        if (pawnLocationSecond && pawns & pawnLocationSecond && oppSide & pawnLocationSecond) {
-            directAttacker = true;
-            attackerSquare = Square::getSetBit(pawnLocationSecond);
-        }
-    }
-    // If any ray attacker exists in any corresponding direction, we are in check.
-    if (directAttacker) {
-        if (isAttackedInDirection(squareMask, side, Direction::North) ||
-            isAttackedInDirection(squareMask, side, Direction::Northeast) ||
-            isAttackedInDirection(squareMask, side, Direction::Northwest) ||
-            isAttackedInDirection(squareMask, side, Direction::South) ||
-            isAttackedInDirection(squareMask, side, Direction::Southeast) ||
-            isAttackedInDirection(squareMask, side, Direction::Southwest) ||
-            isAttackedInDirection(squareMask, side, Direction::East) ||
-            isAttackedInDirection(squareMask, side, Direction::West)) {
-            return std::make_tuple(CheckType::Double, -1);
-        } else {
-            return std::make_tuple(CheckType::Direct, attackerSquare);
-        }
-    } else {
-        // Check number of ray attackers
-        int attackerCount = 0;
-        int attackerSquareTemp;
-        attackerSquareTemp = squareAttackingInDirection(squareMask, side, Direction::North);
-        if (attackerSquareTemp != -1) {
-            ++attackerCount;
-            attackerSquare = attackerSquareTemp;
-        }
-        attackerSquareTemp = squareAttackingInDirection(squareMask, side, Direction::East);
-        if (attackerSquareTemp != -1) {
-            ++attackerCount;
-            attackerSquare = attackerSquareTemp;
-        }
-        attackerSquareTemp = squareAttackingInDirection(squareMask, side, Direction::South);
-        if (attackerSquareTemp != -1) {
-            ++attackerCount;
-            attackerSquare = attackerSquareTemp;
-        }
-        attackerSquareTemp = squareAttackingInDirection(squareMask, side, Direction::West);
-        if (attackerSquareTemp != -1) {
-            ++attackerCount;
-            attackerSquare = attackerSquareTemp;
-        }
-        attackerSquareTemp = squareAttackingInDirection(squareMask, side, Direction::Northeast);
-        if (attackerSquareTemp != -1) {
-            ++attackerCount;
-            attackerSquare = attackerSquareTemp;
-        }
-        attackerSquareTemp = squareAttackingInDirection(squareMask, side, Direction::Northwest);
-        if (attackerSquareTemp != -1) {
-            ++attackerCount;
-            attackerSquare = attackerSquareTemp;
-        }
-        attackerSquareTemp = squareAttackingInDirection(squareMask, side, Direction::Southeast);
-        if (attackerSquareTemp != -1) {
-            ++attackerCount;
-            attackerSquare = attackerSquareTemp;
-        }
-        attackerSquareTemp = squareAttackingInDirection(squareMask, side, Direction::Southwest);
-        if (attackerSquareTemp != -1) {
-            ++attackerCount;
-            attackerSquare = attackerSquareTemp;
-        }
-        if (attackerCount == 0) {
-            return std::make_tuple(CheckType::None, -1);
-        } else if (attackerCount == 1) {
-            return std::make_tuple(CheckType::Ray, attackerSquare);
-        } else {
-            return std::make_tuple(CheckType::Double, attackerSquare);
-        }
-    }
+    // Enemy pawns attack us from the squares our own pawn would capture on
+    return oppSide & ((Attacks::getPawnAttacks(square, side) & pawns) |
+                      (Attacks::getKnightAttacks(square) & knights) |
+                      (Attacks::getKingAttacks(square) & kings) |
+                      (Attacks::getRookAttacks(square, occupancy) & (rooks | queens)) |
+                      (Attacks::getBishopAttacks(square, occupancy) & (bishops | queens)));
 }
 
 bool Board::isInCheck(Side side) const {
@@ -398,220 +183,36 @@ bool Board::isInCheck(Side side) const {
     return isUnderAttack(square, side);
 }
 
-// Returns -1 if there are no squares attacking, otherwise returns square (int) of attacking piece
-int Board::squareAttackingInDirection(Bitboard squareMask, Side side, Direction direction) const {
-    const Bitboard sameSide = (side == Side::White) ? whites : blacks;
-    const Bitboard oppSide = (side == Side::White) ? blacks : whites;
-    // Determine the type of piece to look for based on the direction vector
-    const Bitboard attackingPieces = queens | ((direction == Direction::North || direction == Direction::East || direction == Direction::South || direction == Direction::West) ? rooks : bishops);
-    while (true) {
-        squareMask = Square::getInDirection(squareMask, direction);
-        if (!squareMask) {
-            return -1;
-        }
-        if (sameSide & squareMask) {
-            return -1;
-        } else if (oppSide & squareMask) {
-            if (attackingPieces & squareMask) {
-                return Square::getSetBit(squareMask);
-            } else {
-                return -1;
-            }
-        }
-    }
-}
-
-int Board::captureInDirection(Bitboard squareMask, Side side, Direction direction) const {
-    const Bitboard sameSide = (side == Side::White) ? whites : blacks;
-    const Bitboard oppSide = (side == Side::White) ? blacks : whites;
-    while (true) {
-        squareMask = Square::getInDirection(squareMask, direction);
-        if (!squareMask) {
-            return -1;
-        }
-        if (sameSide & squareMask) {
-            return -1;
-        } else if (oppSide & squareMask) {
-            return Square::getSetBit(squareMask);
-        }
-    }
-}
-
-// We assume that square and movingPiece are in line.
-int Board::getPinningOrAttackingSquare(int square, int movingPiece, Side side) const {
-    const Side oppSide = (side == Side::White) ? Side::Black : Side::White;
-    // Determine if we are looking for bishop or rook based on the direction vector
-    int x;
-    int y;
-    std::tie(x, y) = Square::diff(square, movingPiece);
-    if (x < 0) {
-        x = -1;
-    } else if (x > 0) {
-        x = 1;
-    }
-    if (y < 0) {
-        y = -1;
-    } else if (y > 0) {
-        y = 1;
-    }
-    const Bitboard attackingPieces = queens | ((x == 0 || y == 0) ? rooks : bishops);
-    while (true) {
-        square = Square::getInDirection(square, x, y);
-        if (square == -1) {
-            return -1;
-        }
-        if (square == movingPiece) {
-            continue;
-        }
-        if (isSide(square, side)) {
-            return -1;
-        } else if (isSide(square, oppSide)) {
-            if (attackingPieces & Board::getMask(square)) {
-                return square;
-            } else {
-                return -1;
-            }
-        }
-    }
-}
-
-bool Board::isAttackedInDirection(int square, Side side, int x, int y) const {
-    const Side oppSide = (side == Side::White) ? Side::Black : Side::White;
-    // Determine if we are looking for bishop or rook based on the direction vector
-    const Bitboard enemyVariablePiece = queens | ((x == 0 || y == 0) ? rooks : bishops);
-    while (true) {
-        square = Square::getInDirection(square, x, y);
-        if (square == -1) {
-            return false;
-        }
-        if (isSide(square, side)) {
-            return false;
-        } else if (isSide(square, oppSide)) {
-            return (enemyVariablePiece & Board::getMask(square));
-        }
-    }
-}
-
-bool Board::isAttackedInDirection(Bitboard square, Side side, Direction d) const {
-    const Bitboard sameSide = (side == Side::White) ? whites : blacks;
-    const Bitboard oppSide = (side == Side::White) ? blacks : whites;
-    // Determine if we are looking for bishop or rook based on the direction vector
-    const Bitboard enemyVariablePiece = queens | ((d == Direction::North || d == Direction::South || d == Direction::East || d == Direction::West) ? rooks : bishops);
-    while (true) {
-        square = Square::getInDirection(square, d);
-        if (square == 0) {
-            return false;
-        }
-        if (square & sameSide) {
-            return false;
-        } else if (square & oppSide) {
-            return (enemyVariablePiece & square);
-        }
-    }
-}
-
-bool Board::wouldBeAttackedInDirection(int square, int origin, Side side, int x, int y) const {
-    const Side oppSide = (side == Side::White) ? Side::Black : Side::White;
-    // Determine if we are looking for bishop or rook based on the direction vector
-    const Bitboard enemyVariablePiece = queens | ((x == 0 || y == 0) ? rooks : bishops);
-    while (true) {
-        square = Square::getInDirection(square, x, y);
-        if (square == -1) {
-            return false;
-        }
-        if (square == origin) {
-            continue;
-        }
-        if (isSide(square, side)) {
-            return false;
-        } else if (isSide(square, oppSide)) {
-            return (enemyVariablePiece & Board::getMask(square));
-        }
-    }
-}
-
-bool Board::wouldBeAttackedInDirection(Bitboard square, Bitboard origin, Side side, Direction d) const {
-    const Bitboard sameSide = (side == Side::White) ? whites : blacks;
+Bitboard Board::getPinned(Side side) const {
+    const Bitboard curSide = (side == Side::White) ? whites : blacks;
     const Bitboard oppSide = (side == Side::White) ? blacks : whites;
-    // Determine if we are looking for bishop or rook based on the direction vector
-    const Bitboard enemyVariablePiece = queens | ((d == Direction::North || d == Direction::South || d == Direction::East || d == Direction::West) ? rooks : bishops);
-    while (true) {
-        square = Square::getInDirection(square, d);
-        if (square == 0) {
-            return false;
-        }
-        if (square == origin) {
-            continue;
-        }
-        if (square & sameSide) {
-            return false;
-        } else if (square & oppSide) {
-            return (enemyVariablePiece & square);
+    const Bitboard occupancy = whites | blacks;
+    const int kingLocation = Square::getSetBit(kings & curSide);
+    // Enemy sliders that would attack the king on an empty board
+    Bitboard snipers = oppSide & ((Attacks::getRookAttacks(kingLocation, 0) & (rooks | queens)) |
+                                  (Attacks::getBishopAttacks(kingLocation, 0) & (bishops | queens)));
+    Bitboard pinned = 0;
+    while (snipers) {
+        const Bitboard blockers = Attacks::getBetween(kingLocation, Square::getSetBit(snipers)) & occupancy;
+        // Exactly one piece in the way, and it is ours
+        if (blockers && !(blockers & (blockers - 1))) {
+            pinned |= blockers & curSide;
         }
+        snipers &= snipers - 1;
     }
-}
 
-bool Board::isLegalPieceMove(int origin, int destination) const {
-    const Move move = Move(origin, destination);
-    const Bitboard originMask = Board::getMask(origin);
-    if (pawns & originMask) {
-        if (isEmpty(destination)) {
-            return move.isPawnMove();
-        } else {
-            return move.isPawnCapture();
-        }
-    } else if (knights & originMask) {
-        return move.isKnightMove();
-    } else if (bishops & originMask) {
-        return move.isBishopMove();
-    } else if (rooks & originMask) {
-        return move.isRookMove();
-    } else if (queens & originMask) {
-        return move.isQueenMove();
-    }
+    return pinned;
 }
 
 bool Board::willEnPassantCheck(int capturer, int capturee, Side side) const {
     const Bitboard curSide = (side == Side::White) ? whites : blacks;
     const int kingLocation = Square::getSetBit(kings & curSide);
-    if (Square::getRowB(kingLocation) != Square::getRowB(capturer)) {
-        return false;
-    }
-    const int x = (Square::getColumn(kingLocation) > Square::getColumn(capturer)) ? -1 : 1;
-    const Side oppSide = (side == Side::White) ? Side::Black : Side::White;
-    int square = kingLocation;
-    while (true) {
-        square = Square::getInDirection(square, x, 0);
-        if (square == -1) {
-            return false;
-        }
-        if (square == capturer || square == capturee) {
-            continue;
-        }
-        if (isSide(square, side)) {
-            return false;
-        } else if (isSide(square, oppSide)) {
-            return (queens & Board::getMask(square) || rooks & Board::getMask(square));
-        }
-    }
-}
+    const int destination = (side == Side::White) ? capturee + 8 : capturee - 8;
+    // Both pawns leave their squares and the capturer lands behind the
+    // capturee, which may uncover a slider or fail to resolve a check
+    const Bitboard occupancy = ((whites | blacks) ^ Board::getMask(capturer) ^ Board::getMask(capturee)) | Board::getMask(destination);
 
-void Board::appendUnobstructedMovesInDirection(std::vector<Move> &results, int square, Bitboard squareMask, Side side, Direction direction) const {
-    const Bitboard sameSide = (side == Side::White) ? whites : blacks;
-    const Bitboard oppSide = (side == Side::White) ? blacks : whites;
-    while (true) {
-        squareMask = Square::getInDirection(squareMask, direction);
-        if (!squareMask) {
-            break;
-        }
-        if (sameSide & squareMask) {
-            break;
-        }
-        results.emplace_back(square, Square::getSetBit(squareMask));
-        if (oppSide & squareMask) {
-            break;
-        }
-    }
+    return getAttackers(kingLocation, occupancy, side) & ~Board::getMask(capturee);
 }
 
 bool Board::isSide(int square, Side side) const {
@@ -622,31 +223,6 @@ bool Board::isSide(int square, Side side) const {
     }
 }
 
-bool Board::isObstructedBetween(int a, int b) const {
-    int x;
-    int y;
-    std::tie(x, y) = Square::diff(a, b);
-    if (x > 1) {
-        x = 1;
-    } else if (x < -1) {
-        x = -1;
-    }
-    if (y > 1) {
-        y = 1;
-    } else if (y < -1) {
-        y = -1;
-    }
-    int current = a + (y * 8 + x);
-    while (current != b) {
-        if (!isEmpty(current)) {
-            return true;
-        }
-        current += y * 8 + x;
-    }
-
-    return false;
-}
-
 Bitboard Board::getMask(int square) const {
     return 1ULL << square;
 }
\ No newline at end of file
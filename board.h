@@ -7,15 +7,14 @@
 #ifndef BOARD_H
 #define BOARD_H
 
-#include "checktype.h"
 #include "move.h"
 #include "piece.h"
+#include "psqt.h"
 #include "square.h"
 
 #include <array>
 #include <cstdint>
 #include <string>
-#include <vector>
 
 typedef std::uint64_t Bitboard;
 
@@ -31,11 +30,43 @@ public:
     Bitboard kings;
     Board();
     Board(std::string const &fenString);
-    Board(Board const &);
     void setToStartPosition();
     void print() const;
-    bool isEmpty(int square) const;
+
+    bool isEmpty(int square) const {
+        return mailbox[square] == Piece::None;
+    }
+
+    /* Returns the piece on square, or Piece::None if it is empty */
+    int at(int square) const {
+        return mailbox[square];
+    }
+
     std::string toString() const;
+
+    /* Zobrist key of the pieces on the board, kept up to date by the mutators */
+    std::uint64_t getHash() const {
+        return hash;
+    }
+
+    /* Zobrist key of the pieces computed from scratch, for verification */
+    std::uint64_t computeHash() const;
+
+    /* Zobrist key of the pawns alone, kept up to date by the mutators */
+    std::uint64_t getPawnHash() const {
+        return pawnHash;
+    }
+
+    /* Sum of the piece-square scores of the pieces, white minus black, kept up to date by the mutators */
+    Psqt::Score getPsqtScore() const {
+        return psqtScore;
+    }
+
+    /* Game phase, from the pieces other than pawns and kings, kept up to date by the mutators */
+    int getPhase() const {
+        return phase;
+    }
+
     void addPiece(int square, int piece);
     void movePiece(int origin, int destination);
     void deletePiece(int square);
@@ -43,41 +74,35 @@ public:
     bool isUnderAttack(int square, Side side) const;
     bool wouldBeUnderAttack(int square, int origin, Side side) const;
 
-    int getPinningOrAttackingSquare(int square, int movingPiece, Side side) const;
-
-    std::tuple<CheckType, int> getInCheckStatus(Side side) const;
+    /* Pieces of side that are pinned to their own king */
+    Bitboard getPinned(Side side) const;
 
     /**
-     * Given an origin and a destination, take the piece located at origin and
-     * see if it is capable of moving to destination
-     * Ignores obstructions/checks/etc
+     * Determine if capturing the pawn on capturee en passant with the pawn on
+     * capturer would leave the king of side in check
      */
-    bool isLegalPieceMove(int origin, int destination) const;
-
     bool willEnPassantCheck(int capturer, int capturee, Side side) const;
 
-    void appendUnobstructedMovesInDirection(std::vector<Move> &results, int square, Bitboard squareMask, Side side, Direction direction) const;
-
-    int captureInDirection(Bitboard squareMask, Side side, Direction direction) const;
+    /**
+     * Returns the pieces of the side opposing side which attack square,
+     * given the occupancy used for blocking sliding pieces
+     */
+    Bitboard getAttackers(int square, Bitboard occupancy, Side side) const;
 
     bool isSide(int square, Side side) const;
 
-    /* Determine if a piece can travel from A to B without being obstructed */
-    bool isObstructedBetween(int a, int b) const;
-
     /* Determines if side is in check */
     bool isInCheck(Side side) const;
 
     Bitboard getMask(int square) const;
 
 private:
-    int at(int square) const;
-    bool isAttackedByKnight(int square, Side side) const;
-    int squareAttackingInDirection(Bitboard squareMask, Side side, Direction direction) const;
-    bool isAttackedInDirection(int square, Side side, int x, int y) const;
-    bool isAttackedInDirection(Bitboard square, Side side, Direction d) const;
-    bool wouldBeAttackedInDirection(int square, int origin, Side side, int x, int y) const;
-    bool wouldBeAttackedInDirection(Bitboard square, Bitboard origin, Side side, Direction d) const;
+    // Piece on each square, kept in sync with the bitboards by the mutators
+    std::array<std::int8_t, 64> mailbox;
+    std::uint64_t hash;
+    std::uint64_t pawnHash;
+    Psqt::Score psqtScore;
+    int phase;
 };
 
 #endif
\ No newline at end of file
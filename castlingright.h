@@ -0,0 +1,18 @@
+/*
+ * Castling rights, combined into a 4-bit mask
+ */
+
+#ifndef CASTLINGRIGHT_H
+#define CASTLINGRIGHT_H
+
+class CastlingRight {
+public:
+    static constexpr int None = 0;
+    static constexpr int WhiteKingside = 1;
+    static constexpr int WhiteQueenside = 2;
+    static constexpr int BlackKingside = 4;
+    static constexpr int BlackQueenside = 8;
+    static constexpr int All = 15;
+};
+
+#endif
\ No newline at end of file
@@ -1,11 +0,0 @@
-#ifndef CHECKTYPE_H
-#define CHECKTYPE_H
-
-enum class CheckType {
-    None,
-    Ray,
-    Direct,
-    Double
-};
-
-#endif
\ No newline at end of file
@@ -0,0 +1,39 @@
+#include "cpu.h"
+
+#ifdef CPU_X86_64_ASM
+#include <cpuid.h>
+#endif
+
+bool Cpu::hasPopcnt = false;
+bool Cpu::hasBmi2 = false;
+
+void Cpu::init() {
+#ifdef CPU_X86_64_ASM
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(0, &eax, &ebx, &ecx, &edx)) {
+        return;
+    }
+    const unsigned int maxLeaf = eax;
+    // "AuthenticAMD" is stored across ebx, edx, ecx
+    const bool isAmd = (ebx == 0x68747541 && edx == 0x69746e65 && ecx == 0x444d4163);
+    __get_cpuid(1, &eax, &ebx, &ecx, &edx);
+    hasPopcnt = ecx & bit_POPCNT;
+    const unsigned int family = ((eax >> 8) & 0xF) + ((eax >> 20) & 0xFF);
+    if (maxLeaf >= 7) {
+        __cpuid_count(7, 0, eax, ebx, ecx, edx);
+        // PEXT is microcoded and much slower than a magic multiply on
+        // AMD processors before Zen 3 (family 0x19)
+        hasBmi2 = (ebx & bit_BMI2) && !(isAmd && family < 0x19);
+    }
+#endif
+}
+
+std::string Cpu::getBackendName() {
+    if (hasBmi2) {
+        return "bmi2";
+    } else if (hasPopcnt) {
+        return "popcnt";
+    }
+
+    return "generic";
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+/*
+ * Detection of optional x86-64 instructions at runtime
+ * A single binary is built for the generic target; the bit manipulation
+ * helpers check these flags and use POPCNT/PEXT through inline assembly when
+ * the running CPU supports them, falling back to portable code otherwise
+ */
+
+#ifndef CPU_H
+#define CPU_H
+
+#include <cstdint>
+#include <string>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define CPU_X86_64_ASM
+#endif
+
+namespace Cpu {
+
+extern bool hasPopcnt;
+extern bool hasBmi2;
+
+/**
+ * Query CPUID and set the flags above
+ * Must run before the attack tables are built, as these are laid out
+ * differently when PEXT is used
+ */
+void init();
+
+/* Name of the bit manipulation backend in use, for reporting */
+std::string getBackendName();
+
+inline int popcount(std::uint64_t b) {
+#ifdef CPU_X86_64_ASM
+    if (hasPopcnt) {
+        std::uint64_t result;
+        __asm__("popcntq %1, %0" : "=r"(result) : "rm"(b));
+        return static_cast<int>(result);
+    }
+#endif
+    // SWAR fallback
+    b = b - ((b >> 1) & 0x5555555555555555ULL);
+    b = (b & 0x3333333333333333ULL) + ((b >> 2) & 0x3333333333333333ULL);
+    b = (b + (b >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return static_cast<int>((b * 0x0101010101010101ULL) >> 56);
+}
+
+/* Gather the bits of b selected by mask into the low bits of the result */
+inline std::uint64_t pext(std::uint64_t b, std::uint64_t mask) {
+#ifdef CPU_X86_64_ASM
+    if (hasBmi2) {
+        std::uint64_t result;
+        __asm__("pextq %2, %1, %0" : "=r"(result) : "r"(b), "rm"(mask));
+        return result;
+    }
+#endif
+    std::uint64_t result = 0;
+    for (std::uint64_t bit = 1; mask; bit <<= 1) {
+        if (b & mask & -mask) {
+            result |= bit;
+        }
+        mask &= mask - 1;
+    }
+
+    return result;
+}
+
+} // namespace Cpu
+
+#endif
\ No newline at end of file
@@ -1,147 +1,336 @@
 #include "engine.h"
 
-#include <fstream>
+#include "movepicker.h"
+
+#include <algorithm>
 
 namespace {
 
-void debug(std::string const &msg) {
-    std::ofstream outputFile("debug.log", std::ios::app);
-    outputFile << "---| " << msg << std::endl;
-    outputFile.close();
-}
+constexpr int infinity = 30000; // Fits in a table entry
+constexpr int mateScore = 10000;
 
-}
+// Shallower nodes are not worth the overhead of null move pruning
+constexpr int nullMoveMinDepth = 3;
+
+// Half-width of the first aspiration window, doubled on every fail
+constexpr int aspirationWindow = 25;
+// Scores of shallow iterations are too unstable to aim a window at
+constexpr int aspirationMinDepth = 4;
+
+// Moves are only reduced with this much depth left, and after this many moves
+constexpr int lateMoveMinDepth = 3;
+constexpr int lateMoveMinCount = 3;
 
 /*
- * alpha = lowest possible score we can ensure
- * beta = highest possible score the opponent can achieve, given optimal play by us
+ * Count a node, checking the shared stop flag every 2048 nodes
+ * The main thread also raises the flag once its time or node limit is reached
  */
-Move Engine::alphaBetaPrune(GameState const &gamestate, int depth) {
-    std::vector<Move> moves = gamestate.generateLegalMoves();
-    int alpha = -99999;
-    Move bestMove;
-    for (Move const &move : moves) {
-        GameState branch = GameState(gamestate);
-        branch.processMove(move);
-        int eval = alphaBetaMinimise(branch, alpha, -alpha, depth - 1);
-        debug(move.toString() + " " + std::to_string(eval));
-        if (eval > alpha) {
-            alpha = eval;
-            bestMove = move;
+bool isAborted(Engine::SearchContext &context) {
+    if ((++context.nodes & 2047) == 0) {
+        if (context.limits != nullptr && (context.timer->isHardLimitReached()
+                || (context.limits->nodes > 0 && context.nodes >= context.limits->nodes))) {
+            context.stop = true;
+        }
+        if (context.stop.load(std::memory_order_relaxed)) {
+            context.aborted = true;
         }
     }
+    return context.aborted;
+}
 
-    return bestMove;
 }
 
-/*
- * Same side to play
- */
-int Engine::alphaBetaMaximise(GameState const &gamestate, int alpha, int beta, int depth) {
-    if (depth == 0) {
-        if (gamestate.isLastMovedPieceUnderAttack()) {
-            return quiescenceSearchMaximise(gamestate, alpha, beta, 8);
-        } else {
-            return gamestate.getEvaluation();
+void Engine::PrincipalVariation::update(Move move, PrincipalVariation const &rest) {
+    moves[0] = move;
+    length = std::min(rest.length + 1, SearchLimits::maxDepth);
+    std::copy(rest.moves, rest.moves + length - 1, moves + 1);
+}
+
+std::string Engine::PrincipalVariation::toString() const {
+    std::string result;
+    for (int i = 0; i < length; ++i) {
+        result += (i > 0 ? " " : "") + moves[i].toString();
+    }
+    return result;
+}
+
+Move Engine::search(GameState const &gamestate, SearchLimits const &limits, TranspositionTable &table, ThreadPool &threads,
+        std::vector<PawnTable> &pawnTables, std::atomic<bool> &stop,
+        std::function<void(std::string const &)> const &sendInfo) {
+    const TimeManager timer(limits, gamestate.getSide());
+    table.newSearch();
+    if (static_cast<int>(pawnTables.size()) < threads.size()) {
+        pawnTables.resize(threads.size());
+    }
+    pawnTables[0].resetCounts();
+    threads.start([&](int index) {
+        SearchContext context(table, stop, index, pawnTables[index]);
+        PrincipalVariation pv;
+        // Odd helpers search one ply deeper, filling the table ahead of the main thread
+        for (int depth = 1 + index % 2; depth <= SearchLimits::maxDepth && !context.aborted; ++depth) {
+            searchRoot(gamestate, depth, -infinity, infinity, context, pv);
+        }
+    });
+    SearchContext context(table, stop, 0, pawnTables[0], &limits, &timer);
+    // Stopping before the first root move of depth 1 is searched must still
+    // leave a legal move to play
+    MoveList rootMoves;
+    gamestate.generateLegalMoves(rootMoves);
+    Move bestMove = rootMoves.empty() ? Move::none() : rootMoves[0];
+    int score = 0;
+    long long lastIterationTime = 0;
+    for (int depth = 1; depth <= limits.depth && timer.canStartIteration(lastIterationTime); ++depth) {
+        const long long iterationStart = timer.getElapsed();
+        // Aspiration window: expect the score to stay close to the last
+        // iteration's, and widen the window only if it does not
+        int window = aspirationWindow;
+        int alpha = -infinity;
+        int beta = infinity;
+        if (depth >= aspirationMinDepth) {
+            alpha = std::max(score - window, -infinity);
+            beta = std::min(score + window, infinity);
+        }
+        PrincipalVariation pv;
+        while (true) {
+            score = searchRoot(gamestate, depth, alpha, beta, context, pv);
+            // An interrupted iteration still searched the previous best move
+            // first, so whatever it found is at least as good. After a fail
+            // low, no move was found
+            if (pv.length > 0) {
+                bestMove = pv.moves[0];
+            }
+            if (context.aborted || (score > alpha && score < beta)) {
+                break;
+            }
+            window *= 2;
+            if (score <= alpha) {
+                ++context.stats.aspirationFailLows;
+                alpha = std::max(score - window, -infinity);
+            } else {
+                ++context.stats.aspirationFailHighs;
+                beta = std::min(score + window, infinity);
+            }
         }
+        if (context.aborted) {
+            break;
+        }
+        context.stats.aspirationWindow = beta - alpha;
+        const long long elapsed = timer.getElapsed();
+        lastIterationTime = elapsed - iterationStart;
+        sendInfo("info depth " + std::to_string(depth) + " score cp " + std::to_string(score)
+            + " nodes " + std::to_string(context.nodes) + " time " + std::to_string(elapsed)
+            + (pv.length > 0 ? " pv " + pv.toString() : ""));
+    }
+    // Helpers' results only matter through the table, so stop them as soon as we are done
+    stop = true;
+    threads.wait();
+    SearchStats const &stats = context.stats;
+    sendInfo("info string nodes " + std::to_string(context.nodes)
+        + " null move cutoffs " + std::to_string(stats.nullMoveCutoffs) + "/" + std::to_string(stats.nullMoveSearches)
+        + " reduced " + std::to_string(stats.reducedSearches) + " re-searched " + std::to_string(stats.reSearches)
+        + " aspiration window " + std::to_string(stats.aspirationWindow)
+        + " fail low " + std::to_string(stats.aspirationFailLows)
+        + " fail high " + std::to_string(stats.aspirationFailHighs)
+        + " pawn hash hits " + std::to_string(context.pawnTable.getHits()) + "/" + std::to_string(context.pawnTable.getProbes()));
+
+    return bestMove;
+}
+
+int Engine::searchRoot(GameState const &gamestate, int depth, int alpha, int beta, SearchContext &context,
+        PrincipalVariation &pv) {
+    GameState state = gamestate;
+    pv.length = 0;
+    TTEntry entry;
+    const Move hashMove = context.table.probe(state.getHash(), entry) ? entry.bestMove : Move::none();
+    // Every root move is searched, so take them all from the picker up front
+    // for its ordering: hash move, captures by MVV-LVA, then quiets by history
+    MoveList moves;
+    MovePicker picker(state, hashMove, Move::none(), Move::none(), &context.history);
+    for (Move move = picker.next(); !move.isNone(); move = picker.next()) {
+        moves.push_back(move);
     }
-    std::vector<Move> moves = gamestate.generateLegalMoves();
     if (moves.size() == 0) {
-        return -10000; // Checkmate
-    }
-    for (Move const &move : moves) {
-        GameState branch = GameState(gamestate);
-        branch.processMove(move);
-        int eval = alphaBetaMinimise(branch, alpha, beta, depth - 1);
-        alpha = std::max(alpha, eval);
-        // When eval exceeds or equals beta value, we can do no better.
-        if (beta <= alpha) {
+        return state.isInCheck() ? -mateScore : 0;
+    }
+    // Helpers start on a different move after the hash move, so that threads
+    // don't all search the same subtrees in the same order
+    if (context.threadIndex > 0 && moves.size() > 2) {
+        std::rotate(moves.begin() + 1, moves.begin() + 1 + context.threadIndex % (moves.size() - 1), moves.end());
+    }
+    const int originalAlpha = alpha;
+    PrincipalVariation childPv;
+    for (int i = 0; i < moves.size(); ++i) {
+        const Move move = moves[i];
+        const MoveUndo undo = state.makeMove(move);
+        int score;
+        if (i == 0) {
+            score = -principalVariationSearch(state, -beta, -alpha, depth - 1, 1, context, childPv);
+        } else {
+            score = -principalVariationSearch(state, -alpha - 1, -alpha, depth - 1, 1, context, childPv);
+            if (score > alpha && score < beta) {
+                score = -principalVariationSearch(state, -beta, -alpha, depth - 1, 1, context, childPv);
+            }
+        }
+        state.unmakeMove(move, undo);
+        if (context.aborted) {
+            return alpha;
+        }
+        if (score > alpha) {
+            alpha = score;
+            pv.update(move, childPv);
+        }
+        if (alpha >= beta) {
+            alpha = beta;
             break;
         }
     }
+    const int bound = (alpha >= beta) ? Bound::Lower : (alpha > originalAlpha) ? Bound::Exact : Bound::Upper;
+    context.table.store(state.getHash(), depth, bound, alpha, pv.length > 0 ? pv.moves[0] : Move::none());
 
     return alpha;
 }
 
-int Engine::alphaBetaMinimise(GameState const &gamestate, int alpha, int beta, int depth) {
+int Engine::principalVariationSearch(GameState &gamestate, int alpha, int beta, int depth, int ply, SearchContext &context,
+        PrincipalVariation &pv) {
+    pv.length = 0;
+    if (isAborted(context)) {
+        return 0;
+    }
     if (depth == 0) {
         if (gamestate.isLastMovedPieceUnderAttack()) {
-            return quiescenceSearchMinimise(gamestate, alpha, beta, 8);
+            return quiescenceSearch(gamestate, alpha, beta, 8, context);
         } else {
-            // Evaluations are based on the side to play
-            // In the simulated game state, it is supposed to be the opposite side to play.
-            // So to get evaluation relative to ourselves, reverse sign.
-            return -gamestate.getEvaluation();
+            return gamestate.getEvaluation(context.pawnTable);
         }
     }
-    std::vector<Move> moves = gamestate.generateLegalMoves();
-    if (moves.size() == 0) {
-        // Checkmate
-        return 10000;
-    }
-    for (Move const &move : moves) {
-        GameState branch = GameState(gamestate);
-        branch.processMove(move);
-        int eval = alphaBetaMaximise(branch, alpha, beta, depth - 1);
-        beta = std::min(beta, eval);
-        if (beta <= alpha) {
-            break;
+    const bool isPvNode = beta - alpha > 1;
+    const std::uint64_t hash = gamestate.getHash();
+    TTEntry entry;
+    Move hashMove = Move::none();
+    if (context.table.probe(hash, entry)) {
+        // Cutting off at PV nodes would cut the principal variation short
+        if (!isPvNode && entry.depth >= depth) {
+            if (entry.bound == Bound::Exact ||
+                (entry.bound == Bound::Lower && entry.score >= beta) ||
+                (entry.bound == Bound::Upper && entry.score <= alpha)) {
+                return entry.score;
+            }
         }
+        hashMove = entry.bestMove;
     }
-
-    return beta;
-}
-
-int Engine::quiescenceSearchMaximise(GameState const &gamestate, int alpha, int beta, int depth) {
-    if (depth == 0) {
-        return gamestate.getEvaluation();
+    const bool inCheck = gamestate.isInCheck();
+    // Null move pruning: if passing the turn still fails high in a reduced
+    // search, a real move almost certainly would too. Not done twice in a
+    // row, nor without pieces, where zugzwang makes passing a real advantage
+    if (!isPvNode && !inCheck && depth >= nullMoveMinDepth && !gamestate.isLastMoveNone()
+            && gamestate.hasNonPawnMaterial() && gamestate.getEvaluation(context.pawnTable) >= beta) {
+        const int reduction = 2 + depth / 6;
+        const MoveUndo undo = gamestate.makeNullMove();
+        PrincipalVariation nullPv;
+        const int score = -principalVariationSearch(gamestate, -beta, -beta + 1, std::max(0, depth - 1 - reduction),
+            ply + 1, context, nullPv);
+        gamestate.unmakeNullMove(undo);
+        if (context.aborted) {
+            return 0;
+        }
+        ++context.stats.nullMoveSearches;
+        if (score >= beta) {
+            ++context.stats.nullMoveCutoffs;
+            return beta;
+        }
     }
-    std::vector<Move> moves = gamestate.getNonQuietMoves();
-    if (moves.size() == 0) {
-        if (gamestate.isInCheck()) {
-            return -10000; // Checkmate
+    const Move killer1 = context.history.getKiller(ply, 0);
+    const Move killer2 = context.history.getKiller(ply, 1);
+    MovePicker picker(gamestate, hashMove, killer1, killer2, &context.history);
+    const Move firstMove = picker.next();
+    if (firstMove.isNone()) {
+        return inCheck ? -mateScore : 0; // Checkmate or stalemate
+    }
+    const int originalAlpha = alpha;
+    Move bestMove = Move::none();
+    PrincipalVariation childPv;
+    int moveCount = 0;
+    for (Move move = firstMove; !move.isNone(); move = picker.next()) {
+        ++moveCount;
+        const bool isQuiet = !move.isCapture() && !move.isPromotion();
+        const MoveUndo undo = gamestate.makeMove(move);
+        int score;
+        if (moveCount == 1) {
+            score = -principalVariationSearch(gamestate, -beta, -alpha, depth - 1, ply + 1, context, childPv);
         } else {
-            return gamestate.getEvaluation();
+            // Late move reductions: quiet moves ordered late rarely raise alpha,
+            // so they are first searched to a reduced depth
+            int reduction = 0;
+            if (depth >= lateMoveMinDepth && moveCount > lateMoveMinCount && isQuiet && !inCheck
+                    && move != killer1 && move != killer2 && !gamestate.isInCheck()) {
+                reduction = (isPvNode || moveCount <= 2 * lateMoveMinCount) ? 1 : 2;
+                ++context.stats.reducedSearches;
+            }
+            score = -principalVariationSearch(gamestate, -alpha - 1, -alpha, depth - 1 - reduction, ply + 1, context, childPv);
+            if (score > alpha && reduction > 0) {
+                ++context.stats.reSearches;
+                score = -principalVariationSearch(gamestate, -alpha - 1, -alpha, depth - 1, ply + 1, context, childPv);
+            }
+            // Only possible in PV nodes, as otherwise beta is alpha + 1
+            if (score > alpha && score < beta) {
+                score = -principalVariationSearch(gamestate, -beta, -alpha, depth - 1, ply + 1, context, childPv);
+            }
         }
-    }
-    for (Move const &move : moves) {
-        GameState branch = GameState(gamestate);
-        branch.processMove(move);
-        int eval = quiescenceSearchMinimise(branch, alpha, beta, depth - 1);
-        alpha = std::max(alpha, eval);
-        // When eval exceeds or equals beta value, we can do no better.
-        if (beta <= alpha) {
+        gamestate.unmakeMove(move, undo);
+        if (context.aborted) {
+            return 0;
+        }
+        if (score > alpha) {
+            alpha = score;
+            bestMove = move;
+            pv.update(move, childPv);
+        }
+        if (alpha >= beta) {
+            if (isQuiet) {
+                context.history.update(gamestate.getSide(), move, ply, depth);
+            }
+            alpha = beta;
             break;
         }
     }
+    const int bound = (alpha >= beta) ? Bound::Lower : (alpha > originalAlpha) ? Bound::Exact : Bound::Upper;
+    context.table.store(hash, depth, bound, alpha, bestMove);
 
     return alpha;
 }
 
-int Engine::quiescenceSearchMinimise(GameState const &gamestate, int alpha, int beta, int depth) {
+int Engine::quiescenceSearch(GameState &gamestate, int alpha, int beta, int depth, SearchContext &context) {
+    if (isAborted(context)) {
+        return 0;
+    }
     if (depth == 0) {
-        // Evaluations are based on the side to play
-        // In the simulated game state, it is supposed to be the opposite side to play.
-        // So to get evaluation relative to ourselves, reverse sign.
-        return -gamestate.getEvaluation();
+        return gamestate.getEvaluation(context.pawnTable);
     }
-    std::vector<Move> moves = gamestate.getNonQuietMoves();
-    if (moves.size() == 0) {
-        if (gamestate.isInCheck()) {
-            return 10000; // Checkmate
-        } else {
-            return -gamestate.getEvaluation();
+    const bool inCheck = gamestate.isInCheck();
+    if (!inCheck) {
+        const int standPat = gamestate.getEvaluation(context.pawnTable);
+        if (standPat >= beta) {
+            return beta;
         }
+        alpha = std::max(alpha, standPat);
     }
-    for (Move const &move : moves) {
-        GameState branch = GameState(gamestate);
-        branch.processMove(move);
-        int eval = quiescenceSearchMaximise(branch, alpha, beta, depth - 1);
-        beta = std::min(beta, eval);
-        if (beta <= alpha) {
-            break;
+    MovePicker picker(gamestate, &context.history);
+    const Move firstMove = picker.next();
+    if (firstMove.isNone() && inCheck) {
+        return -mateScore; // Checkmate
+    }
+    for (Move move = firstMove; !move.isNone(); move = picker.next()) {
+        const MoveUndo undo = gamestate.makeMove(move);
+        int score = -quiescenceSearch(gamestate, -beta, -alpha, depth - 1, context);
+        gamestate.unmakeMove(move, undo);
+        if (context.aborted) {
+            return 0;
+        }
+        alpha = std::max(alpha, score);
+        if (alpha >= beta) {
+            return beta;
         }
     }
 
-    return beta;
+    return alpha;
 }
\ No newline at end of file
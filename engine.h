@@ -2,12 +2,102 @@
 #define ENGINE_H
 
 #include "gamestate.h"
+#include "movehistory.h"
+#include "pawntable.h"
+#include "threadpool.h"
+#include "timemanager.h"
+#include "transpositiontable.h"
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
 
 namespace Engine {
 
-Move alphaBetaPrune(GameState const &gamestate, int depth);
-int alphaBetaMaximise(GameState const &gamestate, int alpha, int beta, int depth);
-int alphaBetaMinimise(GameState const &gamestate, int alpha, int beta, int depth);
+/* Counts of pruned and reduced searches, for tuning */
+struct SearchStats {
+    long long nullMoveSearches = 0;
+    long long nullMoveCutoffs = 0;
+    long long reducedSearches = 0; // Late moves searched to a reduced depth
+    long long reSearches = 0; // Reduced searches that failed high and were searched again in full
+    int aspirationWindow = 0; // Width of the root window the last iteration succeeded with
+    long long aspirationFailLows = 0;
+    long long aspirationFailHighs = 0;
+};
+
+/* State of one search thread; the table and the stop flag are shared by all threads */
+struct SearchContext {
+    TranspositionTable &table;
+    std::atomic<bool> &stop;
+    int threadIndex; // 0 for the main thread
+    // Only set for the main thread, which raises stop once these are exceeded
+    SearchLimits const *limits;
+    TimeManager const *timer;
+    long long nodes;
+    bool aborted; // Set once stop has been seen, after which search results are meaningless
+    MoveHistory history;
+    SearchStats stats;
+    PawnTable &pawnTable; // Owned by the caller, so that it is kept across searches
+
+    /* Helpers pass no limits */
+    SearchContext(TranspositionTable &table, std::atomic<bool> &stop, int threadIndex, PawnTable &pawnTable,
+            SearchLimits const *limits = nullptr, TimeManager const *timer = nullptr)
+        : table(table), stop(stop), threadIndex(threadIndex), limits(limits), timer(timer),
+          nodes(0), aborted(false), history(), stats(), pawnTable(pawnTable) {}
+};
+
+/* Moves expected to be played from a position, best first */
+struct PrincipalVariation {
+    Move moves[SearchLimits::maxDepth];
+    int length = 0;
+
+    /* Become move followed by rest */
+    void update(Move move, PrincipalVariation const &rest);
+
+    /* Moves in UCI notation, separated by spaces */
+    std::string toString() const;
+};
+
+/**
+ * Iterative deepening within limits, until the next iteration is not expected
+ * to finish in time or stop is raised from outside. stop must be clear on
+ * entry, and is left set on return
+ * Lazy SMP: every thread in threads searches the root, sharing table, with
+ * helpers varying depth and move order. The main thread's best move is
+ * returned, and helpers are stopped as soon as it is done. If stopped before
+ * any move is searched, some legal move is returned, and Move::none() only
+ * if there are none.
+ * Thread i evaluates pawns through pawnTables[i], which is grown to the
+ * number of threads if it is smaller.
+ * sendInfo is given a UCI info line after each completed iteration.
+ */
+Move search(GameState const &gamestate, SearchLimits const &limits, TranspositionTable &table, ThreadPool &threads,
+        std::vector<PawnTable> &pawnTables, std::atomic<bool> &stop,
+        std::function<void(std::string const &)> const &sendInfo);
+
+/**
+ * Search every root move to depth within [alpha, beta], returning the score
+ * of the best one and filling pv. If no move scores above alpha, pv is left
+ * empty. If the search is aborted, pv holds the best of the moves searched
+ * so far.
+ */
+int searchRoot(GameState const &gamestate, int depth, int alpha, int beta, SearchContext &context,
+        PrincipalVariation &pv);
+
+/**
+ * Negamax principal variation search: scores are relative to the side to
+ * play, and fail hard within [alpha, beta].
+ * The first move is searched with the full window. Later moves are expected
+ * to be worse, so they are only searched with a zero window around alpha to
+ * prove it, and searched again with the full window if that fails.
+ * pv is filled when a move scores within the window.
+ * Quiet moves causing a beta cutoff are recorded in the context's history.
+ * Non-PV nodes are pruned by null moves, and late quiet moves are searched
+ * to a reduced depth first, and again in full if they beat alpha.
+ */
+int principalVariationSearch(GameState &gamestate, int alpha, int beta, int depth, int ply, SearchContext &context,
+        PrincipalVariation &pv);
 
 /**
  * The quiescence search is launched when the last move puts a piece in a
@@ -15,12 +105,10 @@ int alphaBetaMinimise(GameState const &gamestate, int alpha, int beta, int depth
  * Our implementation of quiescence search finds moves that are captures,
  * promotions, and check evasions. Notably, checks are not included in the
  * search.
- * We then apply alpha-beta pruning using the same cutoffs up to this point
- * in the search.
+ * Outside of check, the side to play may stand pat on the static evaluation
+ * instead of capturing.
  */
-int quiescenceSearch(GameState const &gamestate, int alpha, int beta, int depth);
-int quiescenceSearchMaximise(GameState const &gamestate, int alpha, int beta, int depth);
-int quiescenceSearchMinimise(GameState const &gamestate, int alpha, int beta, int depth);
+int quiescenceSearch(GameState &gamestate, int alpha, int beta, int depth, SearchContext &context);
 
 } // namespace Engine
 
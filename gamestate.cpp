@@ -1,8 +1,15 @@
 #include "gamestate.h"
 
+#include "attacks.h"
+#include "castlingright.h"
 #include "piecetype.h"
+#include "zobrist.h"
 
+#include <algorithm>
+#include <array>
+#include <cassert>
 #include <iostream>
+#include <stdexcept>
 
 namespace {
 
@@ -10,26 +17,21 @@ const int row2 = 0b001000;
 const int row3 = 0b010000;
 const int row7 = 0b110000;
 
+constexpr Bitboard firstRow = 0xFFULL;
+constexpr Bitboard thirdRow = 0xFF0000ULL;
+constexpr Bitboard sixthRow = 0xFF0000000000ULL;
+constexpr Bitboard lastRow = 0xFF00000000000000ULL;
+
 }
 
 /* Initialise game state to the starting position */
 GameState::GameState() {
     board.setToStartPosition();
     side = Side::White;
-    canWhiteCastleKingside = true;
-    canWhiteCastleQueenside = true;
-    canBlackCastleKingside = true;
-    canBlackCastleQueenside = true;
-}
-
-GameState::GameState(GameState const &original) {
-    board = original.board;
-    side = original.side;
-    canWhiteCastleKingside = original.canWhiteCastleKingside;
-    canWhiteCastleQueenside = original.canWhiteCastleQueenside;
-    canBlackCastleKingside = original.canBlackCastleKingside;
-    canBlackCastleQueenside = original.canBlackCastleQueenside;
-    moveHistory = original.moveHistory;
+    castlingRights = CastlingRight::All;
+    enPassantSquare = -1;
+    lastMove = Move::none();
+    hash = getStateKey();
 }
 
 GameState::GameState(std::string fenString) {
@@ -45,36 +47,47 @@ GameState::GameState(std::string fenString) {
     fenString.erase(0, index + 1);
     index = fenString.find(" ");
     std::string castleString = fenString.substr(0, index);
-    canWhiteCastleKingside = false;
-    canWhiteCastleQueenside = false;
-    canBlackCastleKingside = false;
-    canBlackCastleQueenside = false;
+    castlingRights = CastlingRight::None;
     if (castleString.find("K") != std::string::npos) {
-        canWhiteCastleKingside = true;
+        castlingRights |= CastlingRight::WhiteKingside;
     }
     if (castleString.find("Q") != std::string::npos) {
-        canWhiteCastleQueenside = true;
+        castlingRights |= CastlingRight::WhiteQueenside;
     }
     if (castleString.find("k") != std::string::npos) {
-        canBlackCastleKingside = true;
+        castlingRights |= CastlingRight::BlackKingside;
     }
     if (castleString.find("q") != std::string::npos) {
-        canBlackCastleQueenside = true;
+        castlingRights |= CastlingRight::BlackQueenside;
     }
 
     fenString.erase(0, index + 1);
     index = fenString.find(" ");
     std::string enPassantString = fenString.substr(0, index);
+    enPassantSquare = -1;
+    lastMove = Move::none();
     if (enPassantString.length() == 2) {
-        int enPassantSquare = Square::fromString(enPassantString);
-        if (Square::getRowB(enPassantSquare) == row3) {
-            moveHistory.emplace_back(Square::getInYDirection(enPassantSquare, -1),
-                                       Square::getInYDirection(enPassantSquare, 1));
+        const int passedSquare = Square::fromString(enPassantString);
+        // The last move must have been the double pawn push over this square
+        if (Square::getRowB(passedSquare) == row3) {
+            lastMove = Move(Square::getInYDirection(passedSquare, -1),
+                            Square::getInYDirection(passedSquare, 1),
+                            MoveFlag::DoublePawnPush);
         } else { // 6
-            moveHistory.emplace_back(Square::getInYDirection(enPassantSquare, 1),
-                                       Square::getInYDirection(enPassantSquare, -1));
+            lastMove = Move(Square::getInYDirection(passedSquare, 1),
+                            Square::getInYDirection(passedSquare, -1),
+                            MoveFlag::DoublePawnPush);
+        }
+        // As in makeMove, only record the square if a pawn can capture there
+        const Side sideThatMoved = (side == Side::White) ? Side::Black : Side::White;
+        const Bitboard currentSide = (side == Side::White) ? board.whites : board.blacks;
+        if (Attacks::getPawnAttacks(passedSquare, sideThatMoved) & board.pawns & currentSide) {
+            enPassantSquare = passedSquare;
         }
     }
+    hash = getStateKey();
+    // The board key was built up piece by piece while parsing
+    assert(getHash() == computeHash());
 }
 
 GameState GameState::loadFromUciString(std::string uciString) {
@@ -93,7 +106,7 @@ GameState GameState::loadFromUciString(std::string uciString) {
             if (nextIndex == std::string::npos) {
                 hasNextMove = false;
             }
-            Move nextMove = Move::fromString(uciString.substr(0, nextIndex));
+            Move nextMove = gamestate.resolveMove(Move::fromString(uciString.substr(0, nextIndex)));
             gamestate.processMove(nextMove);
             uciString.erase(0, nextIndex + 1);
         }
@@ -105,408 +118,433 @@ const Board &GameState::getBoard() const {
     return board;
 }
 
+Side GameState::getSide() const {
+    return side;
+}
+
 namespace {
 
-const int blackQueenRook = Square::get(Column::A, 8);
-const int blackKingRook = Square::get(Column::H, 8);
-const int whiteQueenRook = Square::get(Column::A, 1);
-const int whiteKingRook = Square::get(Column::H, 1);
+/*
+ * Castling rights kept when a move starts or ends on each square
+ * Moving the king or a rook, or capturing a rook, clears the matching rights
+ */
+constexpr std::array<std::uint8_t, 64> makeCastlingRightMasks() {
+    std::array<std::uint8_t, 64> masks {};
+    for (int square = 0; square < 64; ++square) {
+        masks[square] = CastlingRight::All;
+    }
+    masks[0] = CastlingRight::All & ~CastlingRight::WhiteQueenside; // a1
+    masks[4] = CastlingRight::All & ~(CastlingRight::WhiteKingside | CastlingRight::WhiteQueenside); // e1
+    masks[7] = CastlingRight::All & ~CastlingRight::WhiteKingside; // h1
+    masks[56] = CastlingRight::All & ~CastlingRight::BlackQueenside; // a8
+    masks[60] = CastlingRight::All & ~(CastlingRight::BlackKingside | CastlingRight::BlackQueenside); // e8
+    masks[63] = CastlingRight::All & ~CastlingRight::BlackKingside; // h8
+    return masks;
+}
+
+constexpr std::array<std::uint8_t, 64> castlingRightMasks = makeCastlingRightMasks();
 
 }
 
-void GameState::processMove(Move move) {
-    const Bitboard originMask = Square::getMask(move.origin);
-    // Update ability to castle
-
-    if (canWhiteCastleKingside && move.destination == whiteKingRook) {
-        canWhiteCastleKingside = false;
-    }
-    if (canWhiteCastleQueenside && move.destination == whiteQueenRook) {
-        canWhiteCastleQueenside = false;
-    }
-    if (canBlackCastleKingside && move.destination == blackKingRook) {
-        canBlackCastleKingside = false;
-    }
-    if (canBlackCastleQueenside && move.destination == blackQueenRook) {
-        canBlackCastleQueenside = false;
-    }
-    if (side == Side::White && (canWhiteCastleKingside || canWhiteCastleQueenside)) {
-        if (board.kings & originMask) {
-            canWhiteCastleKingside = false;
-            canWhiteCastleQueenside = false;
-        } else if (board.rooks & originMask) {
-            if (move.origin == whiteQueenRook) {
-                canWhiteCastleQueenside = false;
-            } else if (move.origin == whiteKingRook) {
-                canWhiteCastleKingside = false;
-            }
-        }
-    } else if (side == Side::Black && (canBlackCastleKingside || canBlackCastleQueenside)) {
-        if (board.kings & originMask) {
-            canBlackCastleKingside = false;
-            canBlackCastleQueenside = false;
-        } else if (board.rooks & originMask) {
-            if (move.origin == blackQueenRook) {
-                canBlackCastleQueenside = false;
-            } else if (move.origin == blackKingRook) {
-                canBlackCastleKingside = false;
-            }
+Move GameState::resolveMove(Move move) const {
+    MoveList moves;
+    generateLegalMoves(moves);
+    for (Move const &legalMove : moves) {
+        if (legalMove.getOrigin() == move.getOrigin() &&
+            legalMove.getDestination() == move.getDestination() &&
+            legalMove.getPromotion() == move.getPromotion()) {
+            return legalMove;
         }
     }
 
-    if (board.kings & originMask && move.isCastleMove()) {
+    throw std::runtime_error("Illegal move: " + move.toString());
+}
+
+void GameState::processMove(Move move) {
+    makeMove(move);
+}
+
+MoveUndo GameState::makeMove(Move move) {
+    const int origin = move.getOrigin();
+    const int destination = move.getDestination();
+    MoveUndo undo;
+    undo.capturedPiece = Piece::None;
+    undo.capturedSquare = destination;
+    undo.castlingRights = castlingRights;
+    undo.enPassantSquare = enPassantSquare;
+    undo.lastMove = lastMove;
+    undo.hash = hash;
+    hash ^= Zobrist::getCastlingKey(castlingRights);
+    if (enPassantSquare != -1) {
+        hash ^= Zobrist::getEnPassantKey(enPassantSquare);
+    }
+    castlingRights &= castlingRightMasks[origin] & castlingRightMasks[destination];
+    hash ^= Zobrist::getCastlingKey(castlingRights) ^ Zobrist::getSideKey();
+    enPassantSquare = -1;
+    lastMove = move;
+
+    if (move.isCapture()) {
+        if (move.isEnPassant()) {
+            // The captured pawn is behind the destination
+            const int pawnDirection = side == Side::White ? -1 : 1;
+            undo.capturedSquare = Square::getInYDirection(destination, pawnDirection);
+        }
+        undo.capturedPiece = board.at(undo.capturedSquare);
+        board.deletePiece(undo.capturedSquare);
+    } else if (move.isCastle()) {
         // Move rook
         const int kingRow = (side == Side::White) ? 1 : 8;
-        if (Square::getColumn(move.destination) == Column::G) {
+        if (move.getFlags() == MoveFlag::KingCastle) {
             board.movePiece(Square::get(Column::H, kingRow), Square::get(Column::F, kingRow));
-        } else if (Square::getColumn(move.destination) == Column::C) {
+        } else {
             board.movePiece(Square::get(Column::A, kingRow), Square::get(Column::D, kingRow));
         }
-    } else if (board.pawns & originMask && move.isPawnCapture() && board.isEmpty(move.destination)) { // en passant
-        // Remove pawn captured via en passant
-        const int pawnDirection = side == Side::White ? -1 : 1;
-        board.deletePiece(Square::getInYDirection(move.destination, pawnDirection));
     }
-    if (!board.isEmpty(move.destination)) {
-        board.deletePiece(move.destination);
+    board.movePiece(origin, destination);
+    if (move.isPromotion()) {
+        board.deletePiece(destination);
+        board.addPiece(destination, Piece::get(side, move.getPromotion()));
     }
-    board.movePiece(move.origin, move.destination);
-    if (move.promotion != Piece::None) {
-        // Promotion
-        board.deletePiece(move.destination);
-        board.addPiece(move.destination, Piece::get(side, move.promotion));
+    if (move.getFlags() == MoveFlag::DoublePawnPush) {
+        // Only record the en passant square if an enemy pawn can capture
+        // there, so that the key doesn't distinguish otherwise equal positions
+        const int passedSquare = (origin + destination) / 2;
+        const Bitboard oppSide = (side == Side::White) ? board.blacks : board.whites;
+        if (Attacks::getPawnAttacks(passedSquare, side) & board.pawns & oppSide) {
+            enPassantSquare = passedSquare;
+            hash ^= Zobrist::getEnPassantKey(enPassantSquare);
+        }
     }
-    moveHistory.emplace_back(move);
     if (side == Side::White) {
         side = Side::Black;
     } else {
         side = Side::White;
     }
+
+    return undo;
 }
 
-std::vector<Move> GameState::getNonQuietMoves() const {
-    CheckType checkStatus;
-    int checkingSquare;
-    std::tie(checkStatus, checkingSquare) = board.getInCheckStatus(side);
-    switch (checkStatus) {
-        case CheckType::None:
-            return getNonQuietMovesOutsideCheck();
+void GameState::unmakeMove(Move move, MoveUndo const &undo) {
+    const int origin = move.getOrigin();
+    const int destination = move.getDestination();
+    side = (side == Side::White) ? Side::Black : Side::White;
+    if (move.isPromotion()) {
+        board.deletePiece(destination);
+        board.addPiece(destination, Piece::get(side, PieceType::Pawn));
+    }
+    board.movePiece(destination, origin);
+    if (move.isCapture()) {
+        board.addPiece(undo.capturedSquare, undo.capturedPiece);
+    } else if (move.isCastle()) {
+        // Move rook back
+        const int kingRow = (side == Side::White) ? 1 : 8;
+        if (move.getFlags() == MoveFlag::KingCastle) {
+            board.movePiece(Square::get(Column::F, kingRow), Square::get(Column::H, kingRow));
+        } else {
+            board.movePiece(Square::get(Column::D, kingRow), Square::get(Column::A, kingRow));
+        }
+    }
+    castlingRights = undo.castlingRights;
+    enPassantSquare = undo.enPassantSquare;
+    lastMove = undo.lastMove;
+    hash = undo.hash;
+}
+
+MoveUndo GameState::makeNullMove() {
+    MoveUndo undo;
+    undo.capturedPiece = Piece::None;
+    undo.capturedSquare = 0;
+    undo.castlingRights = castlingRights;
+    undo.enPassantSquare = enPassantSquare;
+    undo.lastMove = lastMove;
+    undo.hash = hash;
+    if (enPassantSquare != -1) {
+        hash ^= Zobrist::getEnPassantKey(enPassantSquare);
+        enPassantSquare = -1;
+    }
+    hash ^= Zobrist::getSideKey();
+    lastMove = Move::none();
+    side = (side == Side::White) ? Side::Black : Side::White;
+
+    return undo;
+}
+
+void GameState::unmakeNullMove(MoveUndo const &undo) {
+    side = (side == Side::White) ? Side::Black : Side::White;
+    enPassantSquare = undo.enPassantSquare;
+    lastMove = undo.lastMove;
+    hash = undo.hash;
+}
 
-        case CheckType::Ray:
-            return getMovesInRayCheck(checkingSquare);
+bool GameState::isLastMoveNone() const {
+    return lastMove.isNone();
+}
+
+std::uint64_t GameState::getHash() const {
+    return board.getHash() ^ hash;
+}
 
-        case CheckType::Direct:
-            return getMovesInDirectCheck(checkingSquare);
+std::uint64_t GameState::computeHash() const {
+    return board.computeHash() ^ getStateKey();
+}
 
-        case CheckType::Double:
-            return getKingMoves();
+std::uint64_t GameState::getStateKey() const {
+    std::uint64_t key = Zobrist::getCastlingKey(castlingRights);
+    if (side == Side::Black) {
+        key ^= Zobrist::getSideKey();
     }
+    if (enPassantSquare != -1) {
+        key ^= Zobrist::getEnPassantKey(enPassantSquare);
+    }
+
+    return key;
 }
 
-std::vector<Move> GameState::generateLegalMoves() const {
-    CheckType checkStatus;
-    int checkingSquare;
-    std::tie(checkStatus, checkingSquare) = board.getInCheckStatus(side);
-    switch (checkStatus) {
-        case CheckType::None:
-            return getMovesOutsideCheck();
+MoveMasks GameState::getMoveMasks() const {
+    const Bitboard currentSide = (side == Side::White) ? board.whites : board.blacks;
+    const int kingLocation = Square::getSetBit(board.kings & currentSide);
+    MoveMasks masks;
+    masks.checkers = board.getAttackers(kingLocation, board.whites | board.blacks, side);
+    masks.pinned = board.getPinned(side);
+    if (!masks.checkers) {
+        masks.targets = ~currentSide;
+    } else if (masks.checkers & (masks.checkers - 1)) {
+        masks.targets = 0; // Double check, only the king can move
+    } else {
+        // Capture the checking piece or block the check
+        const int checkingSquare = Square::getSetBit(masks.checkers);
+        masks.targets = masks.checkers | Attacks::getBetween(kingLocation, checkingSquare);
+    }
 
-        case CheckType::Ray:
-            return getMovesInRayCheck(checkingSquare);
+    return masks;
+}
 
-        case CheckType::Direct:
-            return getMovesInDirectCheck(checkingSquare);
+void GameState::getNonQuietMoves(MoveList &moves) const {
+    const MoveMasks masks = getMoveMasks();
+    const Bitboard oppSide = (side == Side::White) ? board.blacks : board.whites;
+    if (masks.checkers) {
+        // All check evasions are non-quiet
+        const Bitboard currentSide = (side == Side::White) ? board.whites : board.blacks;
+        appendLegalMoves(moves, masks, currentSide, masks.targets & oppSide, masks.targets & ~(currentSide | oppSide));
+        appendKingMoves(moves, ~currentSide);
+        return;
+    }
+    generateCaptures(moves);
+}
 
-        case CheckType::Double:
-            return getKingMoves();
+void GameState::generateLegalMoves(MoveList &moves) const {
+    const MoveMasks masks = getMoveMasks();
+    const Bitboard currentSide = (side == Side::White) ? board.whites : board.blacks;
+    const Bitboard oppSide = (side == Side::White) ? board.blacks : board.whites;
+    if (!masks.checkers) {
+        appendCastleMoves(moves);
     }
+    appendLegalMoves(moves, masks, currentSide, masks.targets & oppSide, masks.targets & ~(currentSide | oppSide));
+    appendKingMoves(moves, ~currentSide);
 }
 
-std::vector<Move> GameState::getMovesOutsideCheck() const {
-    std::vector<Move> moves;
-    moves.reserve(40); // Expected number of moves, somewhat arbitrary
+int GameState::countLegalMoves() const {
+    const MoveMasks masks = getMoveMasks();
     const Bitboard currentSide = (side == Side::White) ? board.whites : board.blacks;
+    const Bitboard oppSide = (side == Side::White) ? board.blacks : board.whites;
+    const Bitboard occupancy = board.whites | board.blacks;
     const int kingLocation = Square::getSetBit(board.kings & currentSide);
-    appendCastleMoves(moves);
-    Bitboard queenSquares = board.queens & currentSide;
-    while (queenSquares) {
-        const int square = Square::getSetBit(queenSquares);
-        if (Square::inLine(square, kingLocation)) {
-            const int pinningLocation = board.getPinningOrAttackingSquare(kingLocation, square, side);
-            if (pinningLocation != -1) {
-                const std::vector<int> validDestinations = Square::fromAtoBInclusive(kingLocation, pinningLocation);
-                for (int destination : validDestinations) {
-                    if (destination == square) {
-                        continue;
-                    }
-                    const Move move = Move(square, destination);
-                    if (move.isQueenMove()) {
-                        moves.emplace_back(move);
-                    }
-                }
-            } else {
-                appendQueenMoves(moves, square);
-            }
-        } else {
-            appendQueenMoves(moves, square);
-        }
-        queenSquares &= queenSquares - 1;
+    int count = 0;
+    if (!masks.checkers) {
+        MoveList castles;
+        appendCastleMoves(castles);
+        count += castles.size();
     }
-    Bitboard rookSquares = board.rooks & currentSide;
-    while (rookSquares) {
-        const int square = Square::getSetBit(rookSquares);
-        if (Square::inLine(square, kingLocation)) {
-            const int pinningLocation = board.getPinningOrAttackingSquare(kingLocation, square, side);
-            if (pinningLocation != -1) {
-                const std::vector<int> validDestinations = Square::fromAtoBInclusive(kingLocation, pinningLocation);
-                for (int destination : validDestinations) {
-                    if (destination == square) {
-                        continue;
-                    }
-                    const Move move = Move(square, destination);
-                    if (move.isRookMove()) {
-                        moves.emplace_back(move);
-                    }
-                }
-            } else {
-                appendRookMoves(moves, square);
-            }
-        } else {
-            appendRookMoves(moves, square);
+    Bitboard kingSquares = Attacks::getKingAttacks(kingLocation) & ~currentSide;
+    while (kingSquares) {
+        if (!board.wouldBeUnderAttack(Square::getSetBit(kingSquares), kingLocation, side)) {
+            ++count;
         }
-        rookSquares &= rookSquares - 1;
+        kingSquares &= kingSquares - 1;
+    }
+    if (!masks.targets) {
+        return count; // Double check
     }
-    Bitboard knightSquares = board.knights & currentSide;
+
+    const Bitboard targets = masks.targets & ~currentSide;
+    Bitboard knightSquares = board.knights & currentSide & ~masks.pinned;
     while (knightSquares) {
-        const int square = Square::getSetBit(knightSquares);
-        if (!Square::inLine(square, kingLocation) ||
-            board.getPinningOrAttackingSquare(kingLocation, square, side) == -1) {
-            // Check that we aren't pinned
-            // Knights can't move at all when pinned
-            appendKnightMoves(moves, square);
-        }
+        count += Square::getBitCount(Attacks::getKnightAttacks(Square::getSetBit(knightSquares)) & targets);
         knightSquares &= knightSquares - 1;
     }
-    Bitboard bishopSquares = board.bishops & currentSide;
+    Bitboard bishopSquares = (board.bishops | board.queens) & currentSide;
     while (bishopSquares) {
         const int square = Square::getSetBit(bishopSquares);
-        if (Square::inLine(square, kingLocation)) {
-            const int pinningLocation = board.getPinningOrAttackingSquare(kingLocation, square, side);
-            if (pinningLocation != -1) {
-                const std::vector<int> validDestinations = Square::fromAtoBInclusive(kingLocation, pinningLocation);
-                for (int destination : validDestinations) {
-                    if (destination == square) {
-                        continue;
-                    }
-                    const Move move = Move(square, destination);
-                    if (move.isBishopMove()) {
-                        moves.emplace_back(move);
-                    }
-                }
-            } else {
-                appendBishopMoves(moves, square);
-            }
-        } else {
-            appendBishopMoves(moves, square);
+        Bitboard destinations = Attacks::getBishopAttacks(square, occupancy) & targets;
+        if (masks.pinned & Square::getMask(square)) {
+            destinations &= Attacks::getLine(kingLocation, square);
         }
+        count += Square::getBitCount(destinations);
         bishopSquares &= bishopSquares - 1;
     }
-    Bitboard pawnSquares = board.pawns & currentSide;
-    while (pawnSquares) {
-        const int square = Square::getSetBit(pawnSquares);
-        if (Square::inLine(square, kingLocation)) {
-            const int pinningLocation = board.getPinningOrAttackingSquare(kingLocation, square, side);
-            if (pinningLocation != -1) {
-                const std::vector<int> validDestinations = Square::fromAtoBInclusive(kingLocation, pinningLocation);
-                for (int destination : validDestinations) {
-                    const Move move = Move(square, destination);
-                    if (!board.isEmpty(destination)) {
-                        if (move.isPawnCapture(side)) {
-                            moves.emplace_back(move);
-                        }
-                    } else if (move.isPawnMove(side)) {
-                        moves.emplace_back(move);
-                    }
-                }
-            } else {
-                appendPawnMoves(moves, square);
+    Bitboard rookSquares = (board.rooks | board.queens) & currentSide;
+    while (rookSquares) {
+        const int square = Square::getSetBit(rookSquares);
+        Bitboard destinations = Attacks::getRookAttacks(square, occupancy) & targets;
+        if (masks.pinned & Square::getMask(square)) {
+            destinations &= Attacks::getLine(kingLocation, square);
+        }
+        count += Square::getBitCount(destinations);
+        rookSquares &= rookSquares - 1;
+    }
+
+    // Unpinned pawns are counted all at once, by shifting the whole set
+    const Bitboard pawns = board.pawns & currentSide;
+    const Bitboard unpinnedPawns = pawns & ~masks.pinned;
+    const Bitboard promotionRow = (side == Side::White) ? lastRow : firstRow;
+    const Bitboard doublePushRow = (side == Side::White) ? thirdRow : sixthRow;
+    const Direction forward = (side == Side::White) ? Direction::North : Direction::South;
+    const Bitboard singlePushes = Square::getInDirection(unpinnedPawns, forward) & ~occupancy;
+    const Bitboard doublePushes = Square::getInDirection(singlePushes & doublePushRow, forward) & ~occupancy & targets;
+    const Bitboard leftCaptures = Square::getInDirection(unpinnedPawns, (side == Side::White) ? Direction::Northwest : Direction::Southwest) & oppSide & targets;
+    const Bitboard rightCaptures = Square::getInDirection(unpinnedPawns, (side == Side::White) ? Direction::Northeast : Direction::Southeast) & oppSide & targets;
+    const Bitboard pawnDestinations[3] = { singlePushes & targets, leftCaptures, rightCaptures };
+    for (Bitboard const destinations : pawnDestinations) {
+        // Each promotion counts as four moves
+        count += Square::getBitCount(destinations & ~promotionRow) + 4 * Square::getBitCount(destinations & promotionRow);
+    }
+    count += Square::getBitCount(doublePushes);
+    // Pinned pawns and en passant are rare, so generate those moves instead
+    MoveList rareMoves;
+    Bitboard pinnedPawns = pawns & masks.pinned;
+    while (pinnedPawns) {
+        const int square = Square::getSetBit(pinnedPawns);
+        const Bitboard allowed = Attacks::getLine(kingLocation, square);
+        appendPawnMoves(rareMoves, square, targets & oppSide & allowed, targets & ~occupancy & allowed);
+        pinnedPawns &= pinnedPawns - 1;
+    }
+    if (enPassantSquare != -1) {
+        const int pawnDirection = (side == Side::White) ? -1 : 1;
+        const int capturedSquare = Square::getInYDirection(enPassantSquare, pawnDirection);
+        const Side oppSideToPlay = (side == Side::White) ? Side::Black : Side::White;
+        Bitboard capturers = Attacks::getPawnAttacks(enPassantSquare, oppSideToPlay) & pawns;
+        while (capturers) {
+            if (!board.willEnPassantCheck(Square::getSetBit(capturers), capturedSquare, side)) {
+                ++count;
             }
-        } else {
-            appendPawnMoves(moves, square);
+            capturers &= capturers - 1;
         }
-        pawnSquares &= pawnSquares - 1;
     }
-    appendKingMoves(moves);
 
-    return moves;
+    return count + rareMoves.size();
 }
 
-std::vector<Move> GameState::getMovesInRayCheck(int checkingSquare) const {
-    std::vector<Move> moves;
-    moves.reserve(10);
+void GameState::generateCaptures(MoveList &moves) const {
+    const MoveMasks masks = getMoveMasks();
     const Bitboard currentSide = (side == Side::White) ? board.whites : board.blacks;
-    const int kingLocation = Square::getSetBit(board.kings & currentSide);
-    for (int square = 0; square < 64; ++square) {
-        const Bitboard squareMask = Square::getMask(square);
-        if (!(((side == Side::White) ? board.whites : board.blacks) & squareMask)) {
-            continue;
-        }
-        if (square == kingLocation) { // Piece is king
-            appendKingMoves(moves);
-        } else {
-            if (Square::inLine(kingLocation, square)) {
-                const int pinningSquare = board.getPinningOrAttackingSquare(kingLocation, square, side);
-                if (pinningSquare != -1) {
-                    /*
-                    <---pinningSquare----square----kingLocation--->
-                    where checkingSquare is on another line.
-                    In this case, piece cannot move.
-                    The other possibility:
-                    <-square--pinningSquare=checkingSquare--kingLocation->
-                    where piece has one valid move, which is to capture checkingSquare
-                    */
-                    if (pinningSquare != checkingSquare) {
-                        continue;
-                    }
-                    // One valid move, which is to capture on checkingSquare
-                    const Move move = Move(square, checkingSquare);
-                    if (board.pawns & squareMask) {
-                        if (move.isPawnCapture(side)) {
-                            appendConvertedPawnMoves(moves, square, checkingSquare);
-                        }
-                    } else if (board.isLegalPieceMove(square, checkingSquare)) {
-                        // We still need to check for obstructions
-                        if (board.isObstructedBetween(square, checkingSquare)) {
-                            continue;
-                        }
-                        moves.emplace_back(move);
-                    }
-                    continue;
-                    // TODO: get rid of this continue without breaking logic
-                }
-            }
-            // Piece can only block the check or capture the checking piece
-            // So squares between the king and the checking piece (including checking piece)
-            const std::vector<int> validDestinations = Square::fromAtoBInclusive(kingLocation, checkingSquare);
-            for (int destination : validDestinations) {
-                const Move move = Move(square, destination);
-                if (board.knights & squareMask && move.isKnightMove()) {
-                    moves.emplace_back(move);
-                } else if (board.isLegalPieceMove(square, destination)) { // Pawn/bishop/rook/queen
-                    if (board.isObstructedBetween(square, destination)) {
-                        continue;
-                    }
-                    if (board.pawns & squareMask) {
-                        // Pawns need additional checks that either
-                        // destination is clear or move is a capture
-                        if (board.isEmpty(destination)) {
-                            if (move.isPawnMove(side)) {
-                                appendConvertedPawnMoves(moves, square, destination);
-                            }
-                        } else if (move.isPawnCapture(side)) {
-                            appendConvertedPawnMoves(moves, square, destination);
-                        }
-                    } else {
-                        moves.emplace_back(move);
-                    }
-                }
-            }
-        }
-    }
+    const Bitboard oppSide = (side == Side::White) ? board.blacks : board.whites;
+    const Bitboard promotionRow = (side == Side::White) ? lastRow : firstRow;
+    const Bitboard pawns = board.pawns & currentSide;
+    appendLegalMoves(moves, masks, currentSide & ~pawns, masks.targets & oppSide, 0);
+    appendLegalMoves(moves, masks, pawns, masks.targets & oppSide, masks.targets & promotionRow & ~(currentSide | oppSide));
+    appendKingMoves(moves, oppSide);
+}
 
-    return moves;
+void GameState::generateQuiets(MoveList &moves) const {
+    const MoveMasks masks = getMoveMasks();
+    const Bitboard currentSide = (side == Side::White) ? board.whites : board.blacks;
+    const Bitboard empty = ~(board.whites | board.blacks);
+    const Bitboard promotionRow = (side == Side::White) ? lastRow : firstRow;
+    const Bitboard pawns = board.pawns & currentSide;
+    if (!masks.checkers) {
+        appendCastleMoves(moves);
+    }
+    appendLegalMoves(moves, masks, currentSide & ~pawns, 0, masks.targets & empty);
+    appendLegalMoves(moves, masks, pawns, 0, masks.targets & empty & ~promotionRow);
+    appendKingMoves(moves, empty);
 }
 
-std::vector<Move> GameState::getMovesInDirectCheck(int checkingSquare) const {
-    std::vector<Move> moves;
-    moves.reserve(10);
-    // Can only evade check by capturing attacking piece or by moving king
-    for (int square = 0; square < 64; ++square) {
-        const Bitboard squareMask = Square::getMask(square);
-        if (!(((side == Side::White) ? board.whites : board.blacks) & squareMask)) {
-            continue;
-        }
-        if (board.kings & squareMask) {
-            continue;
-        }
-        // Only valid moves are to capture on checkingSquare
-        // The destination does not have to be checkingSquare
-        // (can capture via en passant)
-        const Move move = Move(square, checkingSquare);
-        const Bitboard currentSide = (side == Side::White) ? board.whites : board.blacks;
-        const int kingLocation = Square::getSetBit(board.kings & currentSide);
-        if (Square::inLine(kingLocation, square)) {
-            if (board.getPinningOrAttackingSquare(kingLocation, square, side) != -1) {
-                // We are pinned and cannot legally capture on checkingSquare
-                continue;
-            }
-        }
-        if (board.pawns & squareMask) {
-            if (canEnPassant(square)) {
-                // It is the en passant pawn that is checking us
-                // Our pawn is in one of two positions relative to our king
-                // On top/bottom or one knight jump away
-                const int pawnDirection = (side == Side::White) ? 1 : -1;
-                const Move enPassant = Move(square, Square::getInYDirection(checkingSquare, pawnDirection));
-                moves.emplace_back(enPassant);
-            } else if (move.isPawnCapture(side)) {
-                moves.emplace_back(move);
-            }
-        } else if (board.knights & squareMask) {
-            if (move.isKnightMove()) {
-                moves.emplace_back(move);
-            }
-        } else {
-            // Bishop/rook/queen
-            if (board.isLegalPieceMove(square, checkingSquare)) {
-                if (board.isObstructedBetween(square, checkingSquare)) {
-                    continue;
-                }
-                moves.emplace_back(move);
-            }
-        }
+bool GameState::isLegal(Move move) const {
+    const Bitboard currentSide = (side == Side::White) ? board.whites : board.blacks;
+    const Bitboard originMask = Square::getMask(move.getOrigin());
+    if (move.isNone() || !(currentSide & originMask)) {
+        return false;
+    }
+    // Generate the moves of the piece on the origin only
+    MoveList moves;
+    const MoveMasks masks = getMoveMasks();
+    if (board.kings & originMask) {
+        if (!masks.checkers) {
+            appendCastleMoves(moves);
+        }
+        appendKingMoves(moves, ~currentSide);
+    } else {
+        const Bitboard oppSide = (side == Side::White) ? board.blacks : board.whites;
+        appendLegalMoves(moves, masks, originMask, masks.targets & oppSide, masks.targets & ~(currentSide | oppSide));
     }
-    appendKingMoves(moves);
 
-    return moves;
+    return std::find(moves.begin(), moves.end(), move) != moves.end();
 }
 
-void GameState::appendKnightMoves(std::vector<Move> &moves, int square) const {
+void GameState::appendLegalMoves(MoveList &moves, MoveMasks const &masks, Bitboard pieces, Bitboard captureTargets, Bitboard quietTargets) const {
+    if (!captureTargets && !quietTargets) {
+        return;
+    }
     const Bitboard currentSide = (side == Side::White) ? board.whites : board.blacks;
-    Bitboard knightSquares = Square::getKnightAttacks(Square::getMask(square)) & ~currentSide;
+    const Bitboard occupancy = board.whites | board.blacks;
+    const Bitboard targets = captureTargets | quietTargets;
+    const int kingLocation = Square::getSetBit(board.kings & currentSide);
+    // Knights can't move at all when pinned
+    Bitboard knightSquares = board.knights & pieces & ~masks.pinned;
     while (knightSquares) {
-        const int destinationSquare = Square::getSetBit(knightSquares);
-        moves.emplace_back(square, destinationSquare);
+        const int square = Square::getSetBit(knightSquares);
+        appendMovesTo(moves, square, Attacks::getKnightAttacks(square) & targets);
         knightSquares &= knightSquares - 1;
     }
+    // Pinned sliders can still move along the line of the pin
+    Bitboard bishopSquares = (board.bishops | board.queens) & pieces;
+    while (bishopSquares) {
+        const int square = Square::getSetBit(bishopSquares);
+        Bitboard destinations = Attacks::getBishopAttacks(square, occupancy) & targets;
+        if (masks.pinned & Square::getMask(square)) {
+            destinations &= Attacks::getLine(kingLocation, square);
+        }
+        appendMovesTo(moves, square, destinations);
+        bishopSquares &= bishopSquares - 1;
+    }
+    Bitboard rookSquares = (board.rooks | board.queens) & pieces;
+    while (rookSquares) {
+        const int square = Square::getSetBit(rookSquares);
+        Bitboard destinations = Attacks::getRookAttacks(square, occupancy) & targets;
+        if (masks.pinned & Square::getMask(square)) {
+            destinations &= Attacks::getLine(kingLocation, square);
+        }
+        appendMovesTo(moves, square, destinations);
+        rookSquares &= rookSquares - 1;
+    }
+    Bitboard pawnSquares = board.pawns & pieces;
+    while (pawnSquares) {
+        const int square = Square::getSetBit(pawnSquares);
+        // En passant is a capture, but its destination is empty
+        // Checks and pins are handled by looking at the position after the capture
+        if (captureTargets && canEnPassant(square)) {
+            const int pawnDirection = (side == Side::White) ? -1 : 1;
+            if (!board.willEnPassantCheck(square, Square::getInYDirection(enPassantSquare, pawnDirection), side)) {
+                moves.emplace_back(square, enPassantSquare, MoveFlag::EnPassant);
+            }
+        }
+        const Bitboard allowed = (masks.pinned & Square::getMask(square)) ? Attacks::getLine(kingLocation, square) : ~0ULL;
+        appendPawnMoves(moves, square, captureTargets & allowed, quietTargets & allowed);
+        pawnSquares &= pawnSquares - 1;
+    }
 }
 
-void GameState::appendBishopMoves(std::vector<Move> &moves, int square) const {
-    const Bitboard squareMask = Square::getMask(square);
-    board.appendUnobstructedMovesInDirection(moves, square, squareMask, side, Direction::Southeast);
-    board.appendUnobstructedMovesInDirection(moves, square, squareMask, side, Direction::Southwest);
-    board.appendUnobstructedMovesInDirection(moves, square, squareMask, side, Direction::Northeast);
-    board.appendUnobstructedMovesInDirection(moves, square, squareMask, side, Direction::Northwest);
-}
-
-void GameState::appendRookMoves(std::vector<Move> &moves, int square) const {
-    const Bitboard squareMask = Square::getMask(square);
-    board.appendUnobstructedMovesInDirection(moves, square, squareMask, side, Direction::North);
-    board.appendUnobstructedMovesInDirection(moves, square, squareMask, side, Direction::East);
-    board.appendUnobstructedMovesInDirection(moves, square, squareMask, side, Direction::South);
-    board.appendUnobstructedMovesInDirection(moves, square, squareMask, side, Direction::West);
-}
-
-void GameState::appendQueenMoves(std::vector<Move> &moves, int square) const {
-    const Bitboard squareMask = Square::getMask(square);
-    board.appendUnobstructedMovesInDirection(moves, square, squareMask, side, Direction::North);
-    board.appendUnobstructedMovesInDirection(moves, square, squareMask, side, Direction::East);
-    board.appendUnobstructedMovesInDirection(moves, square, squareMask, side, Direction::South);
-    board.appendUnobstructedMovesInDirection(moves, square, squareMask, side, Direction::West);
-    board.appendUnobstructedMovesInDirection(moves, square, squareMask, side, Direction::Southeast);
-    board.appendUnobstructedMovesInDirection(moves, square, squareMask, side, Direction::Southwest);
-    board.appendUnobstructedMovesInDirection(moves, square, squareMask, side, Direction::Northeast);
-    board.appendUnobstructedMovesInDirection(moves, square, squareMask, side, Direction::Northwest);
+void GameState::appendMovesTo(MoveList &moves, int square, Bitboard destinations) const {
+    Bitboard captures = destinations & (board.whites | board.blacks);
+    Bitboard quietMoves = destinations ^ captures;
+    while (captures) {
+        moves.emplace_back(square, Square::getSetBit(captures), MoveFlag::Capture);
+        captures &= captures - 1;
+    }
+    while (quietMoves) {
+        moves.emplace_back(square, Square::getSetBit(quietMoves));
+        quietMoves &= quietMoves - 1;
+    }
 }
 
 namespace {
@@ -522,409 +560,120 @@ const int squareG8 = Square::get(Column::G, 8);
 
 }
 
-void GameState::appendCastleMoves(std::vector<Move> &moves) const {
+void GameState::appendCastleMoves(MoveList &moves) const {
     const Bitboard currentSide = (side == Side::White) ? board.whites : board.blacks;
     const int kingLocation = Square::getSetBit(board.kings & currentSide);
     if (side == Side::White) {
-        if (canWhiteCastleKingside) {
+        if (castlingRights & CastlingRight::WhiteKingside) {
             constexpr Bitboard castleMask = 96ULL;
             if (!((board.whites | board.blacks) & castleMask) &&
                 !board.isUnderAttack(squareF1, side) &&
                 !board.isUnderAttack(squareG1, side)) {
-                moves.emplace_back(kingLocation, squareG1);
+                moves.emplace_back(kingLocation, squareG1, MoveFlag::KingCastle);
             }
         }
-        if (canWhiteCastleQueenside) {
+        if (castlingRights & CastlingRight::WhiteQueenside) {
             constexpr Bitboard castleMask = 14ULL;
             if (!((board.whites | board.blacks) & castleMask) &&
                 !board.isUnderAttack(squareD1, side) &&
                 !board.isUnderAttack(squareC1, side)) {
-                moves.emplace_back(kingLocation, squareC1);
+                moves.emplace_back(kingLocation, squareC1, MoveFlag::QueenCastle);
             }
         }
     } else {
-        if (canBlackCastleKingside) {
+        if (castlingRights & CastlingRight::BlackKingside) {
             constexpr Bitboard castleMask = 6917529027641081856ULL;
             if (!((board.whites | board.blacks) & castleMask) &&
                 !board.isUnderAttack(squareF8, side) &&
                 !board.isUnderAttack(squareG8, side)) {
-                moves.emplace_back(kingLocation, squareG8);
+                moves.emplace_back(kingLocation, squareG8, MoveFlag::KingCastle);
             }
         }
-        if (canBlackCastleQueenside) {
+        if (castlingRights & CastlingRight::BlackQueenside) {
             constexpr Bitboard castleMask = 1008806316530991104ULL;
             if (!((board.whites | board.blacks) & castleMask) &&
                 !board.isUnderAttack(squareD8, side) &&
                 !board.isUnderAttack(squareC8, side)) {
-                moves.emplace_back(kingLocation, squareC8);
+                moves.emplace_back(kingLocation, squareC8, MoveFlag::QueenCastle);
             }
         }
     }
 }
 
-void GameState::appendKingMoves(std::vector<Move> &moves) const {
+void GameState::appendKingMoves(MoveList &moves, Bitboard targets) const {
     const Bitboard currentSide = (side == Side::White) ? board.whites : board.blacks;
     const int kingLocation = Square::getSetBit(board.kings & currentSide);
-    Bitboard kingSquares = Square::getKingAttacks(board.kings & currentSide) & ~currentSide;
+    Bitboard kingSquares = Attacks::getKingAttacks(kingLocation) & targets;
     while (kingSquares) {
         const int kingDestination = Square::getSetBit(kingSquares);
         if (!board.wouldBeUnderAttack(kingDestination, kingLocation, side)) {
-            moves.emplace_back(kingLocation, kingDestination);
+            moves.emplace_back(kingLocation, kingDestination, board.isEmpty(kingDestination) ? MoveFlag::Quiet : MoveFlag::Capture);
         }
         kingSquares &= kingSquares - 1;
     }
 }
 
-std::vector<Move> GameState::getKingMoves() const {
-    std::vector<Move> moves;
-    moves.reserve(8);
-    const Bitboard currentSide = (side == Side::White) ? board.whites : board.blacks;
-    const int origin = Square::getSetBit(board.kings & currentSide);
-    Bitboard kingSquares = Square::getKingAttacks(board.kings & currentSide) & ~currentSide;
-    while (kingSquares) {
-        const int kingDestination = Square::getSetBit(kingSquares);
-        if (!board.wouldBeUnderAttack(kingDestination, origin, side)) {
-            moves.emplace_back(origin, kingDestination);
-        }
-        kingSquares &= kingSquares - 1;
-    }
-    return moves;
-}
-
-void GameState::appendPawnMoves(std::vector<Move> &moves, int square) const {
-    const Bitboard squareMask = Square::getMask(square);
-    if (canEnPassant(square)) {
-        if (!board.willEnPassantCheck(moveHistory.back().destination, square, side)) {
-            // Can capture by en passant
-            const int pawnDirection = (side == Side::White) ? 1 : -1;
-            moves.emplace_back(square, Square::getInYDirection(moveHistory.back().destination, pawnDirection));
-        }
-    }
-    const Side oppSide = (side == Side::White) ? Side::Black : Side::White;
+void GameState::appendPawnMoves(MoveList &moves, int square, Bitboard captureTargets, Bitboard quietTargets) const {
     const int originalPawnRow = (side == Side::White) ? row2 : row7;
-    const int pawnDirection = (side == Side::White) ? 1 : -1;
-    const int prePromotionRow = (side == Side::White) ? row7 : row2;
-    const bool canPromote = (Square::getRowB(square) == prePromotionRow);
-    const int leftCaptureSquare = Square::getInDirection(square, -1, pawnDirection);
-    const int rightCaptureSquare = Square::getInDirection(square, 1, pawnDirection);
-    if (leftCaptureSquare != -1 && board.isSide(leftCaptureSquare, oppSide)) {
-        if (canPromote) {
-            std::array<Move, 4> res = {
-                Move(square, leftCaptureSquare, PieceType::Queen),
-                Move(square, leftCaptureSquare, PieceType::Rook),
-                Move(square, leftCaptureSquare, PieceType::Bishop),
-                Move(square, leftCaptureSquare, PieceType::Knight)
-            };
-            moves.insert(moves.end(), res.begin(), res.end());
-        } else {
-            moves.emplace_back(square, leftCaptureSquare);
-        }
-    }
-    if (rightCaptureSquare != -1 && board.isSide(rightCaptureSquare, oppSide)) {
-        if (canPromote) {
-            std::array<Move, 4> res = {
-                Move(square, rightCaptureSquare, PieceType::Queen),
-                Move(square, rightCaptureSquare, PieceType::Rook),
-                Move(square, rightCaptureSquare, PieceType::Bishop),
-                Move(square, rightCaptureSquare, PieceType::Knight)
-            };
-            moves.insert(moves.end(), res.begin(), res.end());
-        } else {
-            moves.emplace_back(square, rightCaptureSquare);
-        }
-    }
-    const int forwardSquare = Square::getInYDirection(square, pawnDirection);
-    if (board.isEmpty(forwardSquare)) {
-        if (canPromote) {
-            std::array<Move, 4> res = {
-                Move(square, forwardSquare, PieceType::Queen),
-                Move(square, forwardSquare, PieceType::Rook),
-                Move(square, forwardSquare, PieceType::Bishop),
-                Move(square, forwardSquare, PieceType::Knight)
-            };
-            moves.insert(moves.end(), res.begin(), res.end());
-        } else {
-            if (Square::getRowB(square) == originalPawnRow) {
-                const int forwardTwoSquares = Square::getInYDirection(square, pawnDirection * 2);
-                if (board.isEmpty(forwardTwoSquares)) {
-                    moves.emplace_back(square, forwardTwoSquares);
-                }
+    Bitboard captureSquares = Attacks::getPawnAttacks(square, side) & captureTargets;
+    while (captureSquares) {
+        appendConvertedPawnMoves(moves, square, Square::getSetBit(captureSquares));
+        captureSquares &= captureSquares - 1;
+    }
+    const Bitboard forwardMask = Attacks::getPawnPushes(square, side);
+    if (!((board.whites | board.blacks) & forwardMask)) {
+        const int forwardSquare = Square::getSetBit(forwardMask);
+        if (forwardMask & quietTargets) {
+            appendConvertedPawnMoves(moves, square, forwardSquare);
+        }
+        if (Square::getRowB(square) == originalPawnRow) {
+            const Bitboard forwardTwoMask = Attacks::getPawnPushes(forwardSquare, side);
+            if (forwardTwoMask & quietTargets & ~(board.whites | board.blacks)) {
+                moves.emplace_back(square, Square::getSetBit(forwardTwoMask), MoveFlag::DoublePawnPush);
             }
-            moves.emplace_back(square, forwardSquare);
         }
     }
 }
 
-void GameState::appendConvertedPawnMoves(std::vector<Move> &moves, int origin, int destination) const {
+void GameState::appendConvertedPawnMoves(MoveList &moves, int origin, int destination) const {
+    const int captureFlag = board.isEmpty(destination) ? MoveFlag::Quiet : MoveFlag::Capture;
     if ((side == Side::White && Square::getRowB(origin) == row7) ||
         (side == Side::Black && Square::getRowB(origin) == row2)) {
-        std::array<Move, 4> promotionMoves = {
-            Move(origin, destination, PieceType::Queen),
-            Move(origin, destination, PieceType::Rook),
-            Move(origin, destination, PieceType::Bishop),
-            Move(origin, destination, PieceType::Knight)
-        };
-        moves.insert(moves.end(), promotionMoves.begin(), promotionMoves.end());
+        moves.emplace_back(origin, destination, captureFlag | Move::getPromotionFlag(PieceType::Queen));
+        moves.emplace_back(origin, destination, captureFlag | Move::getPromotionFlag(PieceType::Rook));
+        moves.emplace_back(origin, destination, captureFlag | Move::getPromotionFlag(PieceType::Bishop));
+        moves.emplace_back(origin, destination, captureFlag | Move::getPromotionFlag(PieceType::Knight));
     } else {
-        moves.emplace_back(origin, destination);
+        moves.emplace_back(origin, destination, captureFlag);
     }
 }
 
-std::vector<Move> GameState::getNonQuietMovesOutsideCheck() const {
-    std::vector<Move> moves;
-    const Bitboard currentSide = (side == Side::White) ? board.whites : board.blacks;
-    const int kingLocation = Square::getSetBit(board.kings & currentSide);
-    for (int square = 0; square < 64; ++square) {
-        const Bitboard squareMask = Square::getMask(square);
-        if (!(currentSide & squareMask)) {
-            continue;
-        }
-        if (square != kingLocation && Square::inLine(square, kingLocation)) {
-            // Need to check for potential pins
-            const int pinningLocation = board.getPinningOrAttackingSquare(kingLocation, square, side);
-            if (pinningLocation != -1) {
-                // Since we are not under check, this has to be a pin.
-                // <---pinningLocation-----square-----kingLocation--->
-                // But we can still move along the line of this pin
-                if (board.pawns & squareMask) {
-                    const Move move = Move(square, pinningLocation);
-                    if (move.isPawnCapture(side)) {
-                        moves.emplace_back(move);
-                    }
-                } else {
-                    // Since our piece is pinned, we know we are the only piece
-                    // between the king and the pinner. Therefore our move
-                    // between them cannot be obstructed.
-                    if (board.isLegalPieceMove(square, pinningLocation)) {
-                        moves.emplace_back(square, pinningLocation);
-                    }
-                }
-            } else {
-                // Piece is not pinned and can be moved freely
-                appendNonQuietLegalPieceMoves(moves, square);
-            }
-        } else {
-            appendNonQuietLegalPieceMoves(moves, square);
-        }
-    }
-
-    return moves;
-}
-
-void GameState::appendNonQuietLegalPieceMoves(std::vector<Move> &moves, int square) const {
-    const Bitboard squareMask = Square::getMask(square);
-    if (board.pawns & squareMask) {
-        appendNonQuietPawnMoves(moves, square);
-    } else if (board.knights & squareMask) {
-        const Bitboard oppSide = (side == Side::White) ? board.blacks : board.whites;
-        Bitboard knightSquares = Square::getKnightAttacks(squareMask) & oppSide;
-        while (knightSquares) {
-            const int destinationSquare = Square::getSetBit(knightSquares);
-            moves.emplace_back(square, destinationSquare);
-            knightSquares &= knightSquares - 1;
-        }
-    } else if (board.bishops & squareMask) {
-        std::array<int, 4> captureDestinations = {
-            board.captureInDirection(squareMask, side, Direction::Northeast),
-            board.captureInDirection(squareMask, side, Direction::Northwest),
-            board.captureInDirection(squareMask, side, Direction::Southeast),
-            board.captureInDirection(squareMask, side, Direction::Southwest)
-        };
-        for (int destination : captureDestinations) {
-            if (destination == -1) {
-                continue;
-            }
-            moves.emplace_back(square, destination);
-        }
-    } else if (board.rooks & squareMask) {
-        std::array<int, 4> captureDestinations = {
-            board.captureInDirection(squareMask, side, Direction::North),
-            board.captureInDirection(squareMask, side, Direction::East),
-            board.captureInDirection(squareMask, side, Direction::South),
-            board.captureInDirection(squareMask, side, Direction::West)
-        };
-        for (int destination : captureDestinations) {
-            if (destination == -1) {
-                continue;
-            }
-            moves.emplace_back(square, destination);
-        }
-    } else if (board.queens & squareMask) {
-        std::array<int, 8> captureDestinations = {
-            board.captureInDirection(squareMask, side, Direction::North),
-            board.captureInDirection(squareMask, side, Direction::East),
-            board.captureInDirection(squareMask, side, Direction::South),
-            board.captureInDirection(squareMask, side, Direction::West),
-            board.captureInDirection(squareMask, side, Direction::Northeast),
-            board.captureInDirection(squareMask, side, Direction::Northwest),
-            board.captureInDirection(squareMask, side, Direction::Southeast),
-            board.captureInDirection(squareMask, side, Direction::Southwest)
-        };
-        for (int destination : captureDestinations) {
-            if (destination == -1) {
-                continue;
-            }
-            moves.emplace_back(square, destination);
-        }
-    } else if (board.kings & squareMask) {
-        appendNonQuietKingMoves(moves);
-    }
-}
-
-// Includes promotions
-void GameState::appendNonQuietPawnMoves(std::vector<Move> &moves, int square) const {
-    if (canEnPassant(square)) {
-        if (!board.willEnPassantCheck(moveHistory.back().destination, square, side)) {
-            // Can capture by en passant
-            const int pawnDirection = (side == Side::White) ? 1 : -1;
-            moves.emplace_back(square, Square::getInYDirection(moveHistory.back().destination, pawnDirection));
-        }
-    }
-    const Side enemySide = (side == Side::White) ? Side::Black : Side::White;
-    const int pawnDirection = (side == Side::White) ? 1 : -1;
-    const int prePromotionRow = (side == Side::White) ? row7 : row2;
-    const bool canPromote = (Square::getRowB(square) == prePromotionRow);
-    const int leftCaptureSquare = Square::getInDirection(square, -1, pawnDirection);
-    if (leftCaptureSquare != -1 && board.isSide(leftCaptureSquare, enemySide)) {
-        if (canPromote) {
-            moves.emplace_back(square, leftCaptureSquare, PieceType::Queen);
-            moves.emplace_back(square, leftCaptureSquare, PieceType::Rook);
-            moves.emplace_back(square, leftCaptureSquare, PieceType::Bishop);
-            moves.emplace_back(square, leftCaptureSquare, PieceType::Knight);
-        } else {
-            moves.emplace_back(square, leftCaptureSquare);
-        }
-    }
-    const int rightCaptureSquare = Square::getInDirection(square, 1, pawnDirection);
-    if (rightCaptureSquare != -1 && board.isSide(rightCaptureSquare, enemySide)) {
-        if (canPromote) {
-            moves.emplace_back(square, rightCaptureSquare, PieceType::Queen);
-            moves.emplace_back(square, rightCaptureSquare, PieceType::Rook);
-            moves.emplace_back(square, rightCaptureSquare, PieceType::Bishop);
-            moves.emplace_back(square, rightCaptureSquare, PieceType::Knight);
-        } else {
-            moves.emplace_back(square, rightCaptureSquare);
-        }
-    }
-    const int forwardSquare = Square::getInYDirection(square, pawnDirection);
-    if (board.isEmpty(forwardSquare)) {
-        if (canPromote) {
-            moves.emplace_back(square, forwardSquare, PieceType::Queen);
-            moves.emplace_back(square, forwardSquare, PieceType::Rook);
-            moves.emplace_back(square, forwardSquare, PieceType::Bishop);
-            moves.emplace_back(square, forwardSquare, PieceType::Knight);
-        }
-    }
-}
-
-void GameState::appendNonQuietKingMoves(std::vector<Move> &moves) const {
-    const Bitboard currentSide = (side == Side::White) ? board.whites : board.blacks;
-    const Bitboard oppSide = (side == Side::White) ? board.blacks : board.whites;
-    const int origin = Square::getSetBit(board.kings & currentSide);
-    Bitboard kingSquares = Square::getKingAttacks(board.kings & currentSide) & oppSide;
-    while (kingSquares) {
-        const int kingDestination = Square::getSetBit(kingSquares);
-        if (!board.wouldBeUnderAttack(kingDestination, origin, side)) {
-            moves.emplace_back(origin, kingDestination);
-        }
-        kingSquares &= kingSquares - 1;
-    }
-}
-
-/**
- * Checks if en passant is possible
- * Does not check if en passant will put us into check
- * Conditions for en passant:
- * - Previous move was a 2 pawn move
- * - Our pawn is now 1 square horizontally adjacent to said pawn
- * Precondition: square contains pawn
- */
 bool GameState::canEnPassant(int square) const {
-    if (moveHistory.size() == 0) {
-        return false; // No previous moves
-    }
-    const Move lastMove = moveHistory.back();
-    if (!lastMove.isTwoSquarePawnMove()) {
-        return false; // Pawn didn't move two squares
-    }
-    const int lastMovedPiece = lastMove.destination;
-    if (!(board.pawns & Square::getMask(lastMovedPiece))) {
-        return false; // Previous moved piece wasn't a pawn
-    }
-    if (Square::getRowB(square) != Square::getRowB(lastMovedPiece)) {
-        return false; // We are not in the same row as the pawn
-    }
-    //if (std::abs(Square::getColumn(square) - Square::getColumn(lastMovedPiece)) != 1) {
-    if (std::abs(square - lastMovedPiece) != 1) {
-        // We already know that they're on the same row, so this is safe
-        return false; // Pawns are not on adjacent columns
-    }
-
-    return true;
+    // A pawn attacks the en passant square exactly when it is next to the
+    // pawn that just moved two squares
+    return enPassantSquare != -1 && (Attacks::getPawnAttacks(square, side) & Square::getMask(enPassantSquare));
 }
 
-namespace {
-
-constexpr Bitboard center6by6 = 35604928818740736ULL;
-constexpr Bitboard center4by4 = 66229406269440ULL;
-
-}
-
-// Evaluates position by number of pieces close to center
-int GameState::getPositionEvaluation() const {
-    const Bitboard currentSide = (side == Side::White) ? board.whites : board.blacks;
-    const Bitboard oppSide = (side == Side::White) ? board.blacks : board.whites;
+int GameState::getEvaluation(PawnTable &pawnTable) const {
+    Psqt::Score total = board.getPsqtScore();
+    total += pawnTable.probe(board);
+    const int score = Psqt::taper(total, board.getPhase());
 
-    return 2 * Square::getBitCount(currentSide & center6by6) +
-           1 * Square::getBitCount(currentSide & center4by4) +
-           -1 * Square::getBitCount(oppSide & center4by4) +
-           -2 * Square::getBitCount(oppSide & center6by6);
-}
-
-int GameState::getCenteredEvaluation() const {
-    const Bitboard currentSide = (side == Side::White) ? board.whites : board.blacks;
-    const Bitboard oppSide = (side == Side::White) ? board.blacks : board.whites;
-    const int bishops = 8 * Square::getBitCount(currentSide & board.bishops & center6by6) +
-                    8 * Square::getBitCount(currentSide & board.bishops & center4by4) +
-                    -8 * Square::getBitCount(oppSide & board.bishops & center6by6) +
-                    -8 * Square::getBitCount(oppSide & board.bishops & center4by4);
-    const int knights = 5 * Square::getBitCount(currentSide & board.knights & center6by6) +
-                    10 * Square::getBitCount(currentSide & board.knights & center4by4) +
-                    -5 * Square::getBitCount(oppSide & board.knights & center6by6) +
-                    -10 * Square::getBitCount(oppSide & board.knights & center4by4);
-    const int kings = -5 * Square::getBitCount(currentSide & board.kings & center6by6) +
-                    -10 * Square::getBitCount(currentSide & board.kings & center4by4) +
-                    5 * Square::getBitCount(oppSide & board.kings & center6by6) +
-                    10 * Square::getBitCount(oppSide & board.kings & center4by4);
-
-    return bishops + knights + kings;
-}
-
-int GameState::getMaterialEvaluation() const {
-    const Bitboard currentSide = (side == Side::White) ? board.whites : board.blacks;
-    const Bitboard oppSide = (side == Side::White) ? board.blacks : board.whites;
-    const int score = 100 * Square::getBitCount(currentSide & board.pawns) +
-                300 * Square::getBitCount(currentSide & (board.bishops | board.knights)) +
-                500 * Square::getBitCount(currentSide & board.rooks) +
-                1000 * Square::getBitCount(currentSide & board.queens) +
-                -100 * Square::getBitCount(oppSide & board.pawns) +
-                -300 * Square::getBitCount(oppSide & (board.bishops | board.knights)) +
-                -500 * Square::getBitCount(oppSide & board.rooks) +
-                -1000 * Square::getBitCount(oppSide & board.queens);
-
-    return score;
-}
-
-int GameState::getEvaluation() const {
-    return getMaterialEvaluation() + getPositionEvaluation() + getCenteredEvaluation();
+    return (side == Side::White) ? score : -score;
 }
 
 bool GameState::isLastMovedPieceUnderAttack() const {
     const Side oppSide = (side == Side::White) ? Side::Black : Side::White;
 
-    return board.isUnderAttack(moveHistory.back().destination, oppSide);
+    return !lastMove.isNone() && board.isUnderAttack(lastMove.getDestination(), oppSide);
 }
 
 bool GameState::isInCheck() const {
     return board.isInCheck(side);
+}
+
+bool GameState::hasNonPawnMaterial() const {
+    const Bitboard currentSide = (side == Side::White) ? board.whites : board.blacks;
+
+    return currentSide & (board.knights | board.bishops | board.rooks | board.queens);
 }
\ No newline at end of file
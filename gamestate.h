@@ -8,86 +8,89 @@
 
 #include "board.h"
 #include "move.h"
+#include "movelist.h"
+#include "pawntable.h"
 
-#include <vector>
+#include <cstdint>
+#include <type_traits>
+
+/*
+ * Everything needed to take back a move made with GameState::makeMove that
+ * cannot be recovered from the move itself
+ */
+struct MoveUndo {
+    int capturedPiece;
+    int capturedSquare; // Differs from the destination for en passant
+    std::uint8_t castlingRights;
+    std::int8_t enPassantSquare;
+    Move lastMove;
+    std::uint64_t hash;
+};
+
+/*
+ * Bitboards describing which moves are legal in a position, computed once
+ * before generating moves
+ */
+struct MoveMasks {
+    Bitboard checkers; // Pieces giving check to the side to play
+    Bitboard pinned; // Pieces of the side to play pinned to their king
+    // Destinations for pieces other than the king: every square when not in
+    // check, the checker and the squares blocking it when in single check,
+    // and nothing in double check
+    Bitboard targets;
+};
 
 class GameState {
 private:
     // Member variables
     Board board;
     Side side; // Side to play
-    // TODO: Store castle flags in a more compact manner
-    bool canWhiteCastleQueenside;
-    bool canWhiteCastleKingside;
-    bool canBlackCastleQueenside;
-    bool canBlackCastleKingside;
-    std::vector<Move> moveHistory; // Used for checking of en passant
+    std::uint8_t castlingRights; // CastlingRight flags
+    // Square passed over by a pawn that just moved two squares, or -1
+    std::int8_t enPassantSquare;
+    Move lastMove; // Move::none() if unknown, e.g. after loading a FEN
+    // Zobrist key of the side to play, castling rights and en passant square
+    // The board keeps the key of the pieces
+    std::uint64_t hash;
 
     // Move generation functions
 
-    // Generate moves when placed in check by a knight or pawn
-    std::vector<Move> getMovesInDirectCheck(int checkingSquare) const;
-
-    //Generate moves when placed in check by a bishop, rook, or queen
-    std::vector<Move> getMovesInRayCheck(int checkingSquare) const;
-
-    std::vector<Move> getMovesOutsideCheck() const;
-    std::vector<Move> getNonQuietMovesOutsideCheck() const;
+    /* Checkers, pins and allowed destinations for the side to play */
+    MoveMasks getMoveMasks() const;
 
     /**
-     * Returns valid king moves
-     * Used for move generation when in double check
+     * Append moves of the non-king pieces in pieces that capture on
+     * captureTargets or move quietly to quietTargets, taking pins into account
+     * En passant is included whenever captureTargets is non-empty
      */
-    std::vector<Move> getKingMoves() const;
+    void appendLegalMoves(MoveList &results, MoveMasks const &masks, Bitboard pieces, Bitboard captureTargets, Bitboard quietTargets) const;
 
-    /**
-     * The following set of functions take in a vector and a square (index)
-     * and append valid moves from that square to the vector.
-     */
-    void appendKingMoves(std::vector<Move> &results) const;
-    void appendPawnMoves(std::vector<Move> &results, int square) const;
-    void appendKnightMoves(std::vector<Move> &results, int square) const;
-    void appendBishopMoves(std::vector<Move> &results, int square) const;
-    void appendRookMoves(std::vector<Move> &results, int square) const;
-    void appendQueenMoves(std::vector<Move> &results, int square) const;
-    void appendCastleMoves(std::vector<Move> &results) const;
-
-    void appendNonQuietLegalPieceMoves(std::vector<Move> &results, int square) const;
-    void appendNonQuietKingMoves(std::vector<Move> &results) const;
-    void appendNonQuietPawnMoves(std::vector<Move> &results, int square) const;
+    /* Append a move from square to each square in destinations */
+    void appendMovesTo(MoveList &results, int square, Bitboard destinations) const;
+
+    /* Append king moves to targets that do not walk into check */
+    void appendKingMoves(MoveList &results, Bitboard targets) const;
+    void appendPawnMoves(MoveList &results, int square, Bitboard captureTargets, Bitboard quietTargets) const;
+    void appendCastleMoves(MoveList &results) const;
 
     /**
      * Check if a pawn move will result in a promotion
      * If so, append the 4 different promotion moves to &results
      * Otherwise, append the move normally.
      */
-    void appendConvertedPawnMoves(std::vector<Move> &results, int origin, int destination) const;
+    void appendConvertedPawnMoves(MoveList &results, int origin, int destination) const;
 
     /**
-     * Determine if a given square is capable of capturing en passant
-     * Precondition: Square is occupied by pawn
+     * Determine if a pawn on a given square attacks the en passant square
+     * Does not check if en passant will put us into check
      */
     bool canEnPassant(int square) const;
 
-    // Evaluation functions
-
-    /**
-     * Evaluates the position and returns a centipawn value, relative to the
-     * side whose turn it is to play
-     */
-    int getPositionEvaluation() const;
-
-    /**
-     * Evaluates the material on the board and returns a centipawn value
-     * relative to the side whose turn it is to play
-     * Pawns 100, Knights and bishops 300, Rooks 500, Queen 1050
-     * King does not have any value
-     */
-    int getMaterialEvaluation() const;
+    /* Zobrist key of everything but the pieces, computed from scratch */
+    std::uint64_t getStateKey() const;
 
 public:
     GameState();
-    GameState(GameState const &original);
 
     /**
      * Construct new gamestate from a given FEN string
@@ -95,26 +98,94 @@ public:
     GameState(std::string fenString);
     static GameState loadFromUciString(std::string uciString);
     const Board &getBoard() const;
+    Side getSide() const;
     void processMove(Move move);
 
     /**
-     * Generate all legal (playable) moves
+     * Find the legal move with the same origin, destination and promotion as
+     * move, which carries the correct flags for this position.
+     * Throws std::runtime_error if there is no such move.
+     */
+    Move resolveMove(Move move) const;
+
+    /**
+     * Play a move in place, returning what is needed to take it back
+     * with unmakeMove. Moves must be unmade in reverse order.
      */
-    std::vector<Move> generateLegalMoves() const;
+    MoveUndo makeMove(Move move);
+    void unmakeMove(Move move, MoveUndo const &undo);
+
+    /**
+     * Pass the turn without moving, for null move pruning. Must not be used
+     * in check. Afterwards the last move is Move::none()
+     */
+    MoveUndo makeNullMove();
+    void unmakeNullMove(MoveUndo const &undo);
+
+    /* Whether the last move was a null move, or is unknown */
+    bool isLastMoveNone() const;
+
+    /* Zobrist key of the position, updated incrementally as moves are made */
+    std::uint64_t getHash() const;
+
+    /* Zobrist key of the position computed from scratch, for verification */
+    std::uint64_t computeHash() const;
+
+    /**
+     * Generate all legal (playable) moves, appending them to results
+     */
+    void generateLegalMoves(MoveList &results) const;
+
+    /**
+     * Count the legal moves, equal to the size of generateLegalMoves, mostly
+     * by popcounts of destination bitboards rather than listing the moves
+     */
+    int countLegalMoves() const;
 
     /**
      * Generate non-quiet moves
      * Currently, these include captures, pawn promotions, and check evasions
      */
-    std::vector<Move> getNonQuietMoves() const;
-    int getEvaluation() const;
-    int getCenteredEvaluation() const;
+    void getNonQuietMoves(MoveList &results) const;
+
+    /**
+     * Generate legal captures, en passant and promotions
+     * Together with generateQuiets, this produces every legal move once
+     */
+    void generateCaptures(MoveList &results) const;
+
+    /* Generate legal moves that are neither captures nor promotions */
+    void generateQuiets(MoveList &results) const;
+
+    /**
+     * Determine if move, including its flags, is legal in this position
+     * Used for moves that did not come from the generator for this
+     * position, such as hash moves and killers
+     */
+    bool isLegal(Move move) const;
+    /**
+     * Evaluates the position and returns a centipawn value, relative to the
+     * side whose turn it is to play
+     * Material and piece-square scores are kept by the board, and pawn
+     * structure scores are looked up in pawnTable, so this mostly blends
+     * their midgame and endgame scores by the game phase
+     */
+    int getEvaluation(PawnTable &pawnTable) const;
     bool isLastMovedPieceUnderAttack() const;
 
     /**
      * Determine if the side to play is currently in check
      */
     bool isInCheck() const;
+
+    /**
+     * Whether the side to play has pieces other than pawns and its king
+     * Without them, zugzwang is common and passing is not a safe estimate
+     */
+    bool hasNonPawnMaterial() const;
 };
 
+// Copied freely by the search, so copies must stay a plain memcpy
+static_assert(std::is_trivially_copyable<GameState>::value, "GameState must be trivially copyable");
+
 #endif
\ No newline at end of file
@@ -1,31 +1,95 @@
 #include "perft.h"
+#include "threadpool.h"
 #include "ucicontroller.h"
 
 #include <bitset>
 #include <chrono>
 #include <ctime>
+#include <exception>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <sstream>
 #include <string>
+#include <vector>
 
 void startUciMode() {
     UciController uc;
     uc.init();
 }
 
+void printSummary(std::vector<Perft::TestResult> const &results) {
+    int passed = 0;
+    for (Perft::TestResult const &result : results) {
+        passed += result.passed;
+    }
+    std::cout << passed << "/" << results.size() << " tests passed" << std::endl;
+}
+
+/*
+ * perft suite <file.epd> [max depth] [output file]
+ * The output file is written as CSV if its name ends in .csv, otherwise JSON
+ */
+void runSuite(std::string const &argumentString) {
+    std::istringstream arguments(argumentString);
+    std::string epdPath;
+    int maxDepth = 6;
+    std::string outputPath;
+    arguments >> epdPath >> maxDepth >> outputPath;
+    if (epdPath.empty()) {
+        std::cout << "Usage: perft suite <file.epd> [max depth] [output file]" << std::endl;
+        return;
+    }
+    std::ifstream epdFile(epdPath);
+    if (!epdFile) {
+        std::cout << "Could not open " << epdPath << std::endl;
+        return;
+    }
+    const std::vector<Perft::TestResult> results = Perft::runTests(Perft::readEpd(epdFile, maxDepth, std::cout), std::cout);
+    printSummary(results);
+    if (outputPath.empty()) {
+        return;
+    }
+    std::ofstream outputFile(outputPath);
+    if (outputPath.size() >= 4 && outputPath.substr(outputPath.size() - 4) == ".csv") {
+        Perft::writeCsv(results, outputFile);
+    } else {
+        Perft::writeJson(results, outputFile);
+    }
+}
+
 void waitForInput() {
     GameState gamestate;
+    // Kept between perft commands so that each run does not start its own threads
+    ThreadPool threads;
     std::string input;
     while (std::getline(std::cin, input)) {
         if (input == "uci") {
             startUciMode();
         } else if (input.length() >= 8 && input.substr(0, 8) == "position") {
-            gamestate = GameState::loadFromUciString(input.substr(9));
+            // A position with an unreadable or illegal move is reported and ignored
+            try {
+                gamestate = GameState::loadFromUciString(input.substr(9));
+            } catch (std::exception const &err) {
+                std::cout << "Ignoring position: " << err.what() << std::endl;
+            }
             gamestate.getBoard().print();
         } else if (input.length() >= 12 && input.substr(0, 12) == "perft divide") {
-            const int perftDepth = stoi(input.substr(13, std::string::npos));
+            // perft divide <depth> [hash size in MB] [threads]
+            std::istringstream arguments(input.substr(13, std::string::npos));
+            int perftDepth = 0;
+            int hashMegabytes = 0;
+            int threadCount = 1;
+            arguments >> perftDepth >> hashMegabytes >> threadCount;
+            std::unique_ptr<PerftCache> cache;
+            if (hashMegabytes > 0) {
+                cache.reset(new PerftCache(hashMegabytes));
+            }
+            if (threadCount != threads.size()) {
+                threads.resize(threadCount);
+            }
             const auto start = std::chrono::steady_clock::now();
-            const std::vector<std::tuple<Move, long long>> perftDivideResult = Perft::divide(gamestate, perftDepth);
+            const std::vector<std::tuple<Move, long long>> perftDivideResult = Perft::divide(gamestate, perftDepth, cache.get(), threads);
             const auto end = std::chrono::steady_clock::now();
             long long total = 0;
             for (std::tuple<Move, long long> const &move : perftDivideResult) {
@@ -35,12 +99,25 @@ void waitForInput() {
             const auto duration = std::chrono::duration_cast<std::chrono::milliseconds> (end - start).count();
             std::cout << "perft(" << perftDepth << ") = " << total << " in " << duration << "ms" << std::endl;
         } else if (input.length() >= 10 && input.substr(0, 10) == "perft test") {
-            Perft::test();
-            std::cout << "5/5 tests passed" << std::endl;
+            printSummary(Perft::test(std::cout));
+        } else if (input.length() >= 11 && input.substr(0, 11) == "perft suite") {
+            runSuite(input.length() > 12 ? input.substr(12, std::string::npos) : "");
         } else if (input.length() >= 5 && input.substr(0, 5) == "perft") {
-            const int perftDepth = stoi(input.substr(6, std::string::npos));
+            // perft <depth> [hash size in MB] [threads]
+            std::istringstream arguments(input.substr(6, std::string::npos));
+            int perftDepth = 0;
+            int hashMegabytes = 0;
+            int threadCount = 1;
+            arguments >> perftDepth >> hashMegabytes >> threadCount;
+            std::unique_ptr<PerftCache> cache;
+            if (hashMegabytes > 0) {
+                cache.reset(new PerftCache(hashMegabytes));
+            }
+            if (threadCount != threads.size()) {
+                threads.resize(threadCount);
+            }
             const auto start = std::chrono::steady_clock::now();
-            const long long perftResult = Perft::perft(gamestate, perftDepth);
+            const long long perftResult = Perft::perft(gamestate, perftDepth, cache.get(), threads);
             const auto end = std::chrono::steady_clock::now();
             const auto duration = std::chrono::duration_cast<std::chrono::milliseconds> (end - start).count();
             std::cout << "perft(" << perftDepth << ") = " << perftResult << " in " << duration << "ms" << std::endl;
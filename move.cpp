@@ -1,5 +1,7 @@
 #include "move.h"
 
+#include "attacks.h"
+
 #include <stdexcept>
 
 namespace {
@@ -9,14 +11,6 @@ static constexpr Bitboard seventhRow = 71776119061217280ULL;
 
 }
 
-Move::Move() {}
-
-Move::Move(int o, int d)
-    : origin(o), destination(d), promotion(Piece::None) {}
-
-Move::Move(int o, int d, int piece)
-    : origin(o), destination(d), promotion(piece) {}
-
 Move Move::fromString(std::string const &str) {
     std::string originSquareString = str.substr(0, 2);
     std::string destSquareString = str.substr(2, 2);
@@ -31,24 +25,25 @@ Move Move::fromString(std::string const &str) {
     if (str.length() >= 5) {
         const char promotionChar = str.at(4);
         const int piece = std::abs(Piece::fromString(promotionChar));
-        return Move(originSquare, destSquare, piece);
+        return Move(originSquare, destSquare, getPromotionFlag(piece));
     } else {
         return Move(originSquare, destSquare);
     }
 }
 
 std::string Move::toString() const {
-    if (promotion != Piece::None) {
-        return Square::toString(origin) + Square::toString(destination) + Piece::getString(promotion);
+    if (isPromotion()) {
+        // UCI uses lower case for the promotion piece, as for black pieces
+        return Square::toString(getOrigin()) + Square::toString(getDestination()) + Piece::getString(-getPromotion());
     } else {
-        return Square::toString(origin) + Square::toString(destination);
+        return Square::toString(getOrigin()) + Square::toString(getDestination());
     }
 }
 
 bool Move::isRookMove() const {
     int x;
     int y;
-    std::tie(x, y) = Square::diff(origin, destination);
+    std::tie(x, y) = Square::diff(getOrigin(), getDestination());
 
     // This includes cases where both x and y are 0, i.e. origin == destination
     // That is checked elsewhere to reduce redundancy
@@ -58,7 +53,7 @@ bool Move::isRookMove() const {
 bool Move::isBishopMove() const {
     int x;
     int y;
-    std::tie(x, y) = Square::diff(origin, destination);
+    std::tie(x, y) = Square::diff(getOrigin(), getDestination());
 
     // This includes cases where both x and y are 0, i.e. origin == destination
     // That is checked elsewhere to reduce redundancy
@@ -68,48 +63,27 @@ bool Move::isBishopMove() const {
 bool Move::isQueenMove() const {
     int x;
     int y;
-    std::tie(x, y) = Square::diff(origin, destination);
+    std::tie(x, y) = Square::diff(getOrigin(), getDestination());
     return (x == 0 || y == 0 || std::abs(x) == std::abs(y));
 }
 
 bool Move::isKnightMove() const {
-    return (1ULL << destination & Square::getKnightAttacks(1ULL << origin));
+    return (1ULL << getDestination() & Attacks::getKnightAttacks(getOrigin()));
 }
 
 // Unused
 bool Move::isKingMove() const {
-    return (1ULL << destination & Square::getKingAttacks(1ULL << origin));
-}
-
-namespace {
-
-const int squareC1 = Square::get(Column::C, 1);
-const int squareE1 = Square::get(Column::E, 1);
-const int squareG1 = Square::get(Column::G, 1);
-const int squareC8 = Square::get(Column::C, 8);
-const int squareE8 = Square::get(Column::E, 8);
-const int squareG8 = Square::get(Column::G, 8);
-
-}
-
-bool Move::isCastleMove() const {
-    if (origin == squareE1) {
-        return (destination == squareC1 || destination == squareG1);
-    } else if (origin == squareE8) {
-        return (destination == squareC8 || destination == squareG8);
-    }
-
-    return false;
+    return (1ULL << getDestination() & Attacks::getKingAttacks(getOrigin()));
 }
 
 bool Move::isPawnMove() const {
     int x;
     int y;
-    std::tie(x, y) = Square::diff(origin, destination);
+    std::tie(x, y) = Square::diff(getOrigin(), getDestination());
     if (x != 0) {
         return false;
     }
-    const Bitboard originMask = 1ULL << origin;
+    const Bitboard originMask = 1ULL << getOrigin();
     if (abs(y) == 1) {
         return true; // Move forward/backwards one space
     } else if (y == 2) {
@@ -125,8 +99,8 @@ bool Move::isPawnMove() const {
 bool Move::isPawnMove(Side side) const {
     int x;
     int y;
-    std::tie(x, y) = Square::diff(origin, destination);
-    const Bitboard originMask = 1ULL << origin;
+    std::tie(x, y) = Square::diff(getOrigin(), getDestination());
+    const Bitboard originMask = 1ULL << getOrigin();
     if (x != 0) {
         return false;
     }
@@ -140,8 +114,8 @@ bool Move::isPawnMove(Side side) const {
 }
 
 bool Move::isTwoSquarePawnMove() const {
-    const int difference = destination - origin;
-    const Bitboard originMask = Square::getMask(origin);
+    const int difference = getDestination() - getOrigin();
+    const Bitboard originMask = Square::getMask(getOrigin());
     if (difference == 16) { // exactly 2 rows apart
         // Pawns have to be in original position to be moved up twice
         return (secondRow & originMask);
@@ -153,8 +127,8 @@ bool Move::isTwoSquarePawnMove() const {
 }
 
 bool Move::isTwoSquarePawnMove(Side side) const {
-    const int difference = destination - origin;
-    const Bitboard originMask = 1ULL << origin;
+    const int difference = getDestination() - getOrigin();
+    const Bitboard originMask = 1ULL << getOrigin();
     if (side == Side::White) {
         return (difference == 16 && secondRow & originMask);
     } else {
@@ -165,7 +139,7 @@ bool Move::isTwoSquarePawnMove(Side side) const {
 bool Move::isPawnCapture() const {
     int x;
     int y;
-    std::tie(x, y) = Square::diff(origin, destination);
+    std::tie(x, y) = Square::diff(getOrigin(), getDestination());
 
     return (std::abs(x) == 1 && std::abs(y) == 1); // Pawn capture
 }
@@ -174,7 +148,7 @@ bool Move::isPawnCapture(Side side) const {
     const int pawnDirection = (side == Side::White) ? 1 : -1;
     int x;
     int y;
-    std::tie(x, y) = Square::diff(origin, destination);
+    std::tie(x, y) = Square::diff(getOrigin(), getDestination());
     if (std::abs(x) == 1 && std::abs(y) == 1) {
         return (y == pawnDirection);
     }
@@ -1,15 +1,17 @@
 /* Representation of a chess move
-   Identified by the origin square and the destination square
-   TODO: Contain information about the piece moved, whether it was a capture,
-   and what piece pawns were promoted to.
+   Packed into 16 bits: the origin square, the destination square and a
+   MoveFlag giving the type of move (capture, castle, en passant, promotion)
 */
 
 #ifndef MOVE_H
 #define MOVE_H
 
+#include "moveflag.h"
 #include "piece.h"
+#include "piecetype.h"
 #include "square.h"
 
+#include <cstdint>
 #include <string>
 
 typedef std::uint64_t Bitboard;
@@ -19,16 +21,77 @@ private:
     static constexpr Bitboard secondRow = 65280ULL;
     static constexpr Bitboard seventhRow = 71776119061217280ULL;
 
+    // Origin in bits 0-5, destination in bits 6-11, flags in bits 12-15
+    std::uint16_t data;
+
 public:
-    int origin;
-    int destination;
-    int promotion;
-    Move();
-    Move(int, int);
-    Move(int, int, int);
+    Move() = default;
+    Move(int o, int d) : data(o | (d << 6)) {}
+    Move(int o, int d, int flags) : data(o | (d << 6) | (flags << 12)) {}
+
+    /* A move from A1 to A1, used to mean "no move" */
+    static Move none() {
+        return Move(0, 0);
+    }
+
+    /* Flag for a promotion to pieceType, without the capture bit */
+    static int getPromotionFlag(int pieceType) {
+        return MoveFlag::Promotion | (pieceType - PieceType::Knight);
+    }
+
+    /**
+     * Parses a move in UCI notation (e.g. e7e8q)
+     * The resulting move only carries the promotion flag, if any; use
+     * GameState::resolveMove to get the flags of the move in a position.
+     */
     static Move fromString(std::string const &str);
     std::string toString() const;
 
+    int getOrigin() const {
+        return data & 0x3F;
+    }
+
+    int getDestination() const {
+        return (data >> 6) & 0x3F;
+    }
+
+    int getFlags() const {
+        return data >> 12;
+    }
+
+    bool isNone() const {
+        return data == 0;
+    }
+
+    bool isCapture() const {
+        return data & (MoveFlag::Capture << 12);
+    }
+
+    bool isPromotion() const {
+        return data & (MoveFlag::Promotion << 12);
+    }
+
+    bool isEnPassant() const {
+        return getFlags() == MoveFlag::EnPassant;
+    }
+
+    bool isCastle() const {
+        return getFlags() == MoveFlag::KingCastle || getFlags() == MoveFlag::QueenCastle;
+    }
+
+    /* Piece type promoted to, or Piece::None if this is not a promotion */
+    int getPromotion() const {
+        return isPromotion() ? (getFlags() & 0b11) + PieceType::Knight : Piece::None;
+    }
+
+    bool operator==(Move const &other) const {
+        return data == other.data;
+    }
+
+    bool operator!=(Move const &other) const {
+        return data != other.data;
+    }
+
     /*
      * The following functions are used for move validation
      * They evaluate whether a certain move /could/ be a legal move of that piece,
@@ -45,12 +108,6 @@ public:
     bool isRookMove() const;
     bool isQueenMove() const;
     bool isKingMove() const;
-
-    /*
-     * Checks if origin is either of the starting king positions (E1/E8)
-     * and that the destination is 2 squares to the left or right of that
-     */
-    bool isCastleMove() const;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,21 @@
+/*
+ * Move types, stored in the top four bits of a Move
+ * Bit 2 marks captures and bit 3 marks promotions. For promotions, the low two
+ * bits hold the piece promoted to, counted from the knight.
+ */
+
+#ifndef MOVEFLAG_H
+#define MOVEFLAG_H
+
+class MoveFlag {
+public:
+    static constexpr int Quiet = 0;
+    static constexpr int DoublePawnPush = 1;
+    static constexpr int KingCastle = 2;
+    static constexpr int QueenCastle = 3;
+    static constexpr int Capture = 4;
+    static constexpr int EnPassant = 5;
+    static constexpr int Promotion = 8;
+};
+
+#endif
\ No newline at end of file
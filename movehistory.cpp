@@ -0,0 +1,37 @@
+#include "movehistory.h"
+
+MoveHistory::MoveHistory() {
+    clear();
+}
+
+void MoveHistory::clear() {
+    for (auto &plyKillers : killers) {
+        plyKillers[0] = plyKillers[1] = Move::none();
+    }
+    for (auto &sideHistory : history) {
+        for (auto &originHistory : sideHistory) {
+            for (int &score : originHistory) {
+                score = 0;
+            }
+        }
+    }
+}
+
+void MoveHistory::update(Side side, Move move, int ply, int depth) {
+    if (killers[ply][0] != move) {
+        killers[ply][1] = killers[ply][0];
+        killers[ply][0] = move;
+    }
+    int &score = history[side == Side::White ? 0 : 1][move.getOrigin()][move.getDestination()];
+    // Deeper cutoffs save more work, so they are worth more
+    score += depth * depth;
+    if (score >= maxScore) {
+        for (auto &sideHistory : history) {
+            for (auto &originHistory : sideHistory) {
+                for (int &entry : originHistory) {
+                    entry /= 2;
+                }
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+/*
+ * Statistics gathered during a search to order quiet moves, which unlike
+ * captures cannot be ranked by what they win
+ * Killer moves are the last two quiet moves to cause a beta cutoff at a ply,
+ * and are likely to do the same in sibling nodes. The butterfly history table
+ * is indexed by side, origin and destination, and accumulates a bonus every
+ * time a quiet move causes a cutoff anywhere in the tree
+ */
+
+#ifndef MOVEHISTORY_H
+#define MOVEHISTORY_H
+
+#include "move.h"
+#include "side.h"
+
+class MoveHistory {
+public:
+    static constexpr int maxPly = 128;
+
+private:
+    // History scores are halved once any reaches this, so that recent cutoffs weigh more
+    static constexpr int maxScore = 1 << 20;
+
+    Move killers[maxPly][2];
+    int history[2][64][64];
+
+public:
+    MoveHistory();
+    void clear();
+
+    Move getKiller(int ply, int slot) const {
+        return killers[ply][slot];
+    }
+
+    int getScore(Side side, Move move) const {
+        return history[side == Side::White ? 0 : 1][move.getOrigin()][move.getDestination()];
+    }
+
+    /* Record that a quiet move caused a beta cutoff at ply, with depth remaining */
+    void update(Side side, Move move, int ply, int depth);
+};
+
+#endif
\ No newline at end of file
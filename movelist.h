@@ -0,0 +1,71 @@
+/*
+ * Fixed-capacity list of moves stored inline, used in place of
+ * std::vector<Move> during move generation so that generating the moves of a
+ * node never touches the heap
+ */
+
+#ifndef MOVELIST_H
+#define MOVELIST_H
+
+#include "move.h"
+
+#include <array>
+
+class MoveList {
+public:
+    // Most legal moves possible in any reachable position
+    static constexpr int capacity = 218;
+
+    MoveList() : count(0) {}
+
+    void push_back(Move const &move) {
+        moves[count++] = move;
+    }
+
+    template <typename... Args>
+    void emplace_back(Args... args) {
+        moves[count++] = Move(args...);
+    }
+
+    void clear() {
+        count = 0;
+    }
+
+    int size() const {
+        return count;
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    Move &operator[](int index) {
+        return moves[index];
+    }
+
+    Move const &operator[](int index) const {
+        return moves[index];
+    }
+
+    Move *begin() {
+        return moves.data();
+    }
+
+    Move *end() {
+        return moves.data() + count;
+    }
+
+    Move const *begin() const {
+        return moves.data();
+    }
+
+    Move const *end() const {
+        return moves.data() + count;
+    }
+
+private:
+    std::array<Move, capacity> moves;
+    int count;
+};
+
+#endif
\ No newline at end of file
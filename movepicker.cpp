@@ -0,0 +1,107 @@
+#include "movepicker.h"
+
+#include <utility>
+
+MovePicker::MovePicker(GameState const &gamestate, Move hashMove, Move killer1, Move killer2,
+        MoveHistory const *history)
+    : gamestate(gamestate), history(history), hashMove(hashMove), killers{ killer1, killer2 },
+      stage(Stage::HashMove), skipQuiets(false), index(0) {}
+
+MovePicker::MovePicker(GameState const &gamestate, MoveHistory const *history)
+    : gamestate(gamestate), history(history), hashMove(Move::none()), killers{ Move::none(), Move::none() },
+      stage(Stage::GenerateCaptures), skipQuiets(!gamestate.isInCheck()), index(0) {}
+
+int MovePicker::getCaptureScore(Move move) const {
+    // En passant is the only capture onto an empty square
+    const int victim = move.isEnPassant() ? PieceType::Pawn : Piece::getType(gamestate.getBoard().at(move.getDestination()));
+    const int attacker = Piece::getType(gamestate.getBoard().at(move.getOrigin()));
+    // Promotions are scored as capturing the piece promoted to
+    return (victim + move.getPromotion()) * 8 - attacker;
+}
+
+Move MovePicker::selectBest() {
+    int best = index;
+    for (int i = index + 1; i < moves.size(); ++i) {
+        if (scores[i] > scores[best]) {
+            best = i;
+        }
+    }
+    std::swap(moves[index], moves[best]);
+    std::swap(scores[index], scores[best]);
+
+    return moves[index++];
+}
+
+Move MovePicker::next() {
+    switch (stage) {
+        case Stage::HashMove:
+            stage = Stage::GenerateCaptures;
+            if (gamestate.isLegal(hashMove)) {
+                return hashMove;
+            }
+            [[fallthrough]];
+
+        case Stage::GenerateCaptures:
+            gamestate.generateCaptures(moves);
+            for (int i = 0; i < moves.size(); ++i) {
+                scores[i] = getCaptureScore(moves[i]);
+            }
+            index = 0;
+            stage = Stage::Captures;
+            [[fallthrough]];
+
+        case Stage::Captures:
+            while (index < moves.size()) {
+                const Move move = selectBest();
+                if (move != hashMove) {
+                    return move;
+                }
+            }
+            if (skipQuiets) {
+                stage = Stage::Done;
+                return Move::none();
+            }
+            index = 0;
+            stage = Stage::Killers;
+            [[fallthrough]];
+
+        case Stage::Killers:
+            while (index < 2) {
+                const Move killer = killers[index++];
+                if (killer == hashMove || (index == 2 && killer == killers[0])) {
+                    continue;
+                }
+                // Captures and promotions were handed out with the captures
+                if (!killer.isCapture() && !killer.isPromotion() && gamestate.isLegal(killer)) {
+                    return killer;
+                }
+            }
+            stage = Stage::GenerateQuiets;
+            [[fallthrough]];
+
+        case Stage::GenerateQuiets:
+            moves.clear();
+            gamestate.generateQuiets(moves);
+            for (int i = 0; i < moves.size(); ++i) {
+                scores[i] = history ? history->getScore(gamestate.getSide(), moves[i]) : 0;
+            }
+            index = 0;
+            stage = Stage::Quiets;
+            [[fallthrough]];
+
+        case Stage::Quiets:
+            while (index < moves.size()) {
+                const Move move = selectBest();
+                if (move != hashMove && move != killers[0] && move != killers[1]) {
+                    return move;
+                }
+            }
+            stage = Stage::Done;
+            [[fallthrough]];
+
+        case Stage::Done:
+            break;
+    }
+
+    return Move::none();
+}
\ No newline at end of file
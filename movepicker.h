@@ -0,0 +1,64 @@
+/*
+ * Hands out the legal moves of a position one at a time, in the order most
+ * likely to cause a cutoff: the hash move, captures, killer moves and finally
+ * quiet moves
+ * Each group is only generated once the previous one has been exhausted, so
+ * a cutoff early on saves generating the rest
+ * Within a group, moves are handed out best first by selection: captures by
+ * MVV-LVA (most valuable victim, then least valuable attacker) and quiet
+ * moves by their history score
+ */
+
+#ifndef MOVEPICKER_H
+#define MOVEPICKER_H
+
+#include "gamestate.h"
+#include "move.h"
+#include "movehistory.h"
+#include "movelist.h"
+
+class MovePicker {
+private:
+    enum class Stage {
+        HashMove,
+        GenerateCaptures,
+        Captures,
+        Killers,
+        GenerateQuiets,
+        Quiets,
+        Done
+    };
+
+    // Must be in the same position whenever next is called
+    GameState const &gamestate;
+    MoveHistory const *history;
+    Move hashMove;
+    Move killers[2];
+    Stage stage;
+    bool skipQuiets;
+    MoveList moves;
+    int scores[MoveList::capacity]; // Ordering score of each move in moves
+    int index; // Next move to hand out from moves, or next killer
+
+    int getCaptureScore(Move move) const;
+
+    /* Swap the best scored move not yet handed out into index, and return it */
+    Move selectBest();
+
+public:
+    /**
+     * Picker for the main search
+     * Move::none() may be passed for any moves that are not available, and
+     * history may be null
+     */
+    MovePicker(GameState const &gamestate, Move hashMove, Move killer1, Move killer2,
+        MoveHistory const *history = nullptr);
+
+    /* Picker for the quiescence search: captures and promotions, or every evasion when in check */
+    explicit MovePicker(GameState const &gamestate, MoveHistory const *history = nullptr);
+
+    /* Returns the next legal move, or Move::none() when there are no more */
+    Move next();
+};
+
+#endif
\ No newline at end of file
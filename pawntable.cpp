@@ -0,0 +1,105 @@
+#include "pawntable.h"
+
+#include "square.h"
+
+namespace {
+
+constexpr Bitboard columnA = 0x0101010101010101ULL;
+constexpr Bitboard columnH = columnA << 7;
+
+// Bonus for a passed pawn by row, from its own side
+constexpr Psqt::Score passedBonus[8] = {
+    { 0, 0 }, { 5, 10 }, { 10, 15 }, { 15, 25 }, { 25, 45 }, { 40, 70 }, { 60, 110 }, { 0, 0 }
+};
+constexpr Psqt::Score doubledPenalty = { -10, -20 };
+constexpr Psqt::Score isolatedPenalty = { -10, -15 };
+constexpr Psqt::Score backwardPenalty = { -8, -10 };
+
+Bitboard fillUp(Bitboard b) {
+    b |= b << 8;
+    b |= b << 16;
+    b |= b << 32;
+    return b;
+}
+
+Bitboard fillDown(Bitboard b) {
+    b |= b >> 8;
+    b |= b >> 16;
+    b |= b >> 32;
+    return b;
+}
+
+/* Squares one column to either side of b */
+Bitboard getNeighbours(Bitboard b) {
+    return ((b << 1) & ~columnA) | ((b >> 1) & ~columnH);
+}
+
+Psqt::Score scale(Psqt::Score score, int count) {
+    return { score.midgame * count, score.endgame * count };
+}
+
+/*
+ * Score of the pawns of one side, given as if it were white, so that black is
+ * evaluated with its board flipped vertically
+ */
+Psqt::Score evaluateSide(Bitboard pawns, Bitboard enemyPawns) {
+    Psqt::Score score = { 0, 0 };
+    const Bitboard behind = fillDown(pawns) >> 8; // Squares behind our pawns
+    const Bitboard enemyAhead = fillDown(enemyPawns) >> 8; // Squares in front of enemy pawns
+    const Bitboard enemyAttacks = getNeighbours(enemyPawns) >> 8;
+    // Squares our pawns attack, now or after advancing
+    const Bitboard defensibleSquares = fillUp(getNeighbours(pawns) << 8);
+
+    // Pawns behind another of ours in the same column
+    score += scale(doubledPenalty, Square::getBitCount(pawns & behind));
+
+    const Bitboard columns = fillUp(fillDown(pawns));
+    score += scale(isolatedPenalty, Square::getBitCount(pawns & ~getNeighbours(columns)));
+
+    // Pawns that can't be supported by their neighbours, and can't advance
+    // safely either, as an enemy pawn attacks the square in front of them
+    const Bitboard backward = pawns & ((enemyAttacks & ~defensibleSquares) >> 8);
+    score += scale(backwardPenalty, Square::getBitCount(backward));
+
+    // Pawns with no enemy pawn in front of them in their own or neighbouring
+    // columns. Of doubled pawns, only the front one counts
+    Bitboard passed = pawns & ~(enemyAhead | getNeighbours(enemyAhead) | behind);
+    while (passed) {
+        const int square = Square::getSetBit(passed);
+        score += passedBonus[square / 8];
+        passed &= passed - 1;
+    }
+
+    return score;
+}
+
+/* Mirror b vertically, so that row 1 becomes row 8 */
+Bitboard flip(Bitboard b) {
+    return __builtin_bswap64(b);
+}
+
+}
+
+// Key 0, with no pawns on the board, matches the cleared entries, whose score is correctly zero
+PawnTable::PawnTable(int size) : entries(size, Entry { 0, { 0, 0 } }), indexMask(size - 1), probes(0), hits(0) {}
+
+Psqt::Score PawnTable::probe(Board const &board) {
+    const std::uint64_t key = board.getPawnHash();
+    Entry &entry = entries[key & indexMask];
+    ++probes;
+    if (entry.key == key) {
+        ++hits;
+        return entry.score;
+    }
+    entry.key = key;
+    entry.score = evaluate(board.pawns & board.whites, board.pawns & board.blacks);
+
+    return entry.score;
+}
+
+Psqt::Score PawnTable::evaluate(Bitboard whitePawns, Bitboard blackPawns) {
+    Psqt::Score score = evaluateSide(whitePawns, blackPawns);
+    score -= evaluateSide(flip(blackPawns), flip(whitePawns));
+
+    return score;
+}
\ No newline at end of file
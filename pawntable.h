@@ -0,0 +1,60 @@
+/*
+ * Pawn structure evaluation, cached by pawn configuration
+ * Passed, isolated, doubled and backward pawns are found with bitboard fills
+ * over the pawns of both sides. The same pawn structures recur across much
+ * of the search tree, so results are kept in a direct mapped table indexed by
+ * the board's pawn-only Zobrist key, and rarely need computing
+ * Not shared between threads: each search thread has its own
+ */
+
+#ifndef PAWNTABLE_H
+#define PAWNTABLE_H
+
+#include "board.h"
+#include "psqt.h"
+
+#include <cstdint>
+#include <vector>
+
+class PawnTable {
+private:
+    struct Entry {
+        std::uint64_t key;
+        Psqt::Score score;
+    };
+
+    std::vector<Entry> entries;
+    std::uint64_t indexMask;
+    long long probes;
+    long long hits;
+
+public:
+    static constexpr int defaultEntries = 1 << 14;
+
+    PawnTable() : PawnTable(defaultEntries) {}
+
+    /* size is the number of entries, and must be a power of two */
+    explicit PawnTable(int size);
+
+    /* Pawn structure score of board, white minus black */
+    Psqt::Score probe(Board const &board);
+
+    long long getProbes() const {
+        return probes;
+    }
+
+    long long getHits() const {
+        return hits;
+    }
+
+    /* Reset the probe and hit counts, keeping the entries */
+    void resetCounts() {
+        probes = 0;
+        hits = 0;
+    }
+
+    /* Pawn structure score computed from scratch */
+    static Psqt::Score evaluate(Bitboard whitePawns, Bitboard blackPawns);
+};
+
+#endif
\ No newline at end of file
@@ -2,54 +2,255 @@
 
 #include "move.h"
 
-#include <assert.h>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <sstream>
+#include <vector>
 
-long long Perft::perft(GameState const &gamestate, int depth) {
+long long Perft::perft(GameState &gamestate, int depth, PerftCache *cache) {
     if (depth == 0) {
         return 1;
     }
-    std::vector<Move> moves = gamestate.generateLegalMoves();
+    long long total = 0;
+    // Counting the moves at depth 1 is cheaper than a cache lookup
+    const bool useCache = cache && depth > 1;
+    if (useCache && cache->probe(gamestate.getHash(), depth, total)) {
+        return total;
+    }
     if (depth == 1) {
-        return moves.size();
+        return gamestate.countLegalMoves();
     }
-    long long total = 0;
+    MoveList moves;
+    gamestate.generateLegalMoves(moves);
     for (Move const &move : moves) {
-        GameState branch = GameState(gamestate);
-        branch.processMove(move);
-        total += perft(branch, depth - 1);
+        const MoveUndo undo = gamestate.makeMove(move);
+        total += perft(gamestate, depth - 1, cache);
+        gamestate.unmakeMove(move, undo);
+    }
+    if (useCache) {
+        cache->store(gamestate.getHash(), depth, total);
     }
     return total;
 }
 
-std::vector<std::tuple<Move, long long>> Perft::divide(GameState const &gamestate, int depth) {
+namespace {
+
+/* A subtree two plies below the root, counted by one thread */
+struct Subtree {
+    int rootIndex;
+    Move rootMove;
+    Move reply;
+};
+
+/*
+ * Count the nodes below each root move, splitting the work into subtrees at
+ * the second ply so that one large root move doesn't leave other threads idle
+ * Threads take subtrees from a shared counter until none are left
+ * Precondition: depth >= 2
+ */
+std::vector<long long> countInParallel(GameState const &gamestate, MoveList const &rootMoves, int depth, PerftCache *cache, ThreadPool &threads) {
+    std::vector<Subtree> subtrees;
+    GameState state = gamestate;
+    for (int i = 0; i < rootMoves.size(); ++i) {
+        const MoveUndo undo = state.makeMove(rootMoves[i]);
+        MoveList replies;
+        state.generateLegalMoves(replies);
+        for (Move const &reply : replies) {
+            subtrees.push_back({ i, rootMoves[i], reply });
+        }
+        state.unmakeMove(rootMoves[i], undo);
+    }
+
+    std::vector<std::atomic<long long>> totals(rootMoves.size());
+    for (std::atomic<long long> &total : totals) {
+        total = 0;
+    }
+    std::atomic<std::size_t> nextSubtree(0);
+    const auto work = [&]() {
+        GameState threadState = gamestate;
+        for (std::size_t i = nextSubtree++; i < subtrees.size(); i = nextSubtree++) {
+            Subtree const &subtree = subtrees[i];
+            const MoveUndo rootUndo = threadState.makeMove(subtree.rootMove);
+            const MoveUndo replyUndo = threadState.makeMove(subtree.reply);
+            totals[subtree.rootIndex] += Perft::perft(threadState, depth - 2, cache);
+            threadState.unmakeMove(subtree.reply, replyUndo);
+            threadState.unmakeMove(subtree.rootMove, rootUndo);
+        }
+    };
+    threads.start([&](int) { work(); });
+    work();
+    threads.wait();
+
+    std::vector<long long> results;
+    for (std::atomic<long long> const &total : totals) {
+        results.push_back(total);
+    }
+    return results;
+}
+
+}
+
+std::vector<std::tuple<Move, long long>> Perft::divide(GameState const &gamestate, int depth, PerftCache *cache) {
     std::vector<std::tuple<Move, long long>> results;
-    std::vector<Move> moves = gamestate.generateLegalMoves();
+    GameState state = gamestate;
+    MoveList moves;
+    state.generateLegalMoves(moves);
     for (Move const &move : moves) {
-        GameState branch = GameState(gamestate);
-        branch.processMove(move);
-        long long total = perft(branch, depth - 1);
+        const MoveUndo undo = state.makeMove(move);
+        long long total = perft(state, depth - 1, cache);
+        state.unmakeMove(move, undo);
         results.push_back(std::make_tuple(move, total));
     }
     return results;
 }
 
-struct PerftTestCase {
-    std::string fenString;
-    int depth;
-    long long result;
-};
+std::vector<std::tuple<Move, long long>> Perft::divide(GameState const &gamestate, int depth, PerftCache *cache, ThreadPool &threads) {
+    if (threads.size() <= 1 || depth < 3) {
+        return divide(gamestate, depth, cache);
+    }
+    std::vector<std::tuple<Move, long long>> results;
+    MoveList moves;
+    gamestate.generateLegalMoves(moves);
+    const std::vector<long long> totals = countInParallel(gamestate, moves, depth, cache, threads);
+    for (int i = 0; i < moves.size(); ++i) {
+        results.push_back(std::make_tuple(moves[i], totals[i]));
+    }
+    return results;
+}
 
-void Perft::test() {
-    std::vector<PerftTestCase> testcases;
+long long Perft::perft(GameState const &gamestate, int depth, PerftCache *cache, ThreadPool &threads) {
+    if (threads.size() <= 1 || depth < 3) {
+        GameState state = gamestate;
+        return perft(state, depth, cache);
+    }
+    long long total = 0;
+    for (std::tuple<Move, long long> const &result : divide(gamestate, depth, cache, threads)) {
+        total += std::get<1>(result);
+    }
+    return total;
+}
+
+std::vector<Perft::TestResult> Perft::runTests(std::vector<TestCase> const &testcases, std::ostream &log) {
+    std::vector<TestResult> results;
+    for (TestCase const &testcase : testcases) {
+        GameState testState = GameState(testcase.fenString);
+        const auto start = std::chrono::steady_clock::now();
+        const long long nodes = perft(testState, testcase.depth);
+        const auto end = std::chrono::steady_clock::now();
+        TestResult result;
+        result.testcase = testcase;
+        result.nodes = nodes;
+        result.passed = (nodes == testcase.result);
+        result.milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+        results.push_back(result);
+        log << (result.passed ? "PASS " : "FAIL ") << testcase.fenString << " depth " << testcase.depth
+            << ": " << nodes << " nodes (expected " << testcase.result << ") in "
+            << static_cast<long long>(result.milliseconds) << "ms, " << result.getNodesPerSecond() << " nps" << std::endl;
+    }
+    return results;
+}
+
+std::vector<Perft::TestResult> Perft::test(std::ostream &log) {
+    std::vector<TestCase> testcases;
     testcases.push_back({ "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -", 4, 4085603 });
     testcases.push_back({ "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 4, 3894594 });
     testcases.push_back({ "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - -", 6, 11030083 });
     testcases.push_back({ "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 5, 15833292 });
     testcases.push_back({ "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 5, 89941194 });
 
-    for (PerftTestCase const &testcase : testcases) {
-        GameState testState = GameState(testcase.fenString);
-        const long long result = perft(testState, testcase.depth);
-        assert(result == testcase.result);
+    std::vector<TestResult> results = runTests(testcases, log);
+
+    // When in check every legal move is an evasion, so the non-quiet generator must match
+    // the legal one; b2c3 would block the bishop only if pawns could push diagonally
+    const std::string inCheckFen = "4k3/8/8/8/1b6/8/1P6/4K3 w - - 0 1";
+    GameState inCheck = GameState(inCheckFen);
+    MoveList legalMoves;
+    MoveList nonQuietMoves;
+    inCheck.generateLegalMoves(legalMoves);
+    inCheck.getNonQuietMoves(nonQuietMoves);
+    TestResult result;
+    result.testcase = { inCheckFen, 1, legalMoves.size() };
+    result.nodes = nonQuietMoves.size();
+    result.passed = (result.nodes == result.testcase.result);
+    result.milliseconds = 0;
+    results.push_back(result);
+    log << (result.passed ? "PASS " : "FAIL ") << result.testcase.fenString << " non-quiet moves in check: "
+        << result.nodes << " (expected " << result.testcase.result << ")" << std::endl;
+    return results;
+}
+
+std::vector<Perft::TestCase> Perft::readEpd(std::istream &input, int maxDepth, std::ostream &log) {
+    std::vector<TestCase> testcases;
+    std::string line;
+    while (std::getline(input, line)) {
+        // <fen> ;D1 <count> ;D2 <count> ...
+        std::istringstream fields(line);
+        std::string fenString;
+        std::getline(fields, fenString, ';');
+        fenString.erase(fenString.find_last_not_of(" \t\r") + 1);
+        if (fenString.empty()) {
+            continue;
+        }
+        TestCase testcase = { fenString, 0, 0 };
+        std::string field;
+        while (std::getline(fields, field, ';')) {
+            std::istringstream depthField(field);
+            std::string depthString;
+            long long count;
+            if (!(depthField >> depthString)) {
+                continue; // Empty, as after a trailing ';'
+            }
+            // The depth is at most a few digits, so that it always fits an int
+            if (!(depthField >> count) || depthString.size() < 2 || depthString.size() > 4 || depthString[0] != 'D'
+                    || !std::all_of(depthString.begin() + 1, depthString.end(), [](unsigned char c) { return std::isdigit(c); })) {
+                log << "SKIP malformed field \"" << field << "\" of " << fenString << std::endl;
+                continue;
+            }
+            const int depth = std::stoi(depthString.substr(1));
+            // Take the deepest count that does not exceed maxDepth
+            if (depth <= maxDepth && depth > testcase.depth) {
+                testcase.depth = depth;
+                testcase.result = count;
+            }
+        }
+        if (testcase.depth > 0) {
+            testcases.push_back(testcase);
+        }
     }
-}
\ No newline at end of file
+    return testcases;
+}
+
+void Perft::writeJson(std::vector<TestResult> const &results, std::ostream &output) {
+    int passed = 0;
+    long long nodes = 0;
+    double milliseconds = 0;
+    output << "{\n  \"positions\": [";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        TestResult const &result = results[i];
+        passed += result.passed;
+        nodes += result.nodes;
+        milliseconds += result.milliseconds;
+        output << (i ? ",\n" : "\n") << "    { \"fen\": \"" << result.testcase.fenString
+               << "\", \"depth\": " << result.testcase.depth
+               << ", \"expected\": " << result.testcase.result
+               << ", \"nodes\": " << result.nodes
+               << ", \"passed\": " << (result.passed ? "true" : "false")
+               << ", \"milliseconds\": " << result.milliseconds
+               << ", \"nps\": " << result.getNodesPerSecond() << " }";
+    }
+    const long long nps = (milliseconds > 0) ? static_cast<long long>(nodes * 1000 / milliseconds) : 0;
+    output << "\n  ],\n  \"passed\": " << passed << ",\n  \"total\": " << results.size()
+           << ",\n  \"nodes\": " << nodes << ",\n  \"milliseconds\": " << milliseconds
+           << ",\n  \"nps\": " << nps << "\n}" << std::endl;
+}
+
+void Perft::writeCsv(std::vector<TestResult> const &results, std::ostream &output) {
+    output << "fen,depth,expected,nodes,passed,milliseconds,nps" << std::endl;
+    for (TestResult const &result : results) {
+        output << result.testcase.fenString << "," << result.testcase.depth << "," << result.testcase.result << ","
+               << result.nodes << "," << (result.passed ? "true" : "false") << ","
+               << result.milliseconds << "," << result.getNodesPerSecond() << std::endl;
+    }
+}
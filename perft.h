@@ -2,12 +2,60 @@
 #define PERFT_H
 
 #include "gamestate.h"
+#include "perftcache.h"
+#include "threadpool.h"
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <tuple>
+#include <vector>
 
 namespace Perft {
 
-long long perft(GameState const &state, int depth);
-std::vector<std::tuple<Move, long long>> divide(GameState const &state, int depth);
-void test();
+struct TestCase {
+    std::string fenString;
+    int depth;
+    long long result; // Expected node count
+};
+
+struct TestResult {
+    TestCase testcase;
+    long long nodes;
+    bool passed;
+    double milliseconds;
+
+    long long getNodesPerSecond() const {
+        return (milliseconds > 0) ? static_cast<long long>(nodes * 1000 / milliseconds) : 0;
+    }
+};
+
+/* Count leaf nodes at depth, looking up and storing subtree counts in cache if given */
+long long perft(GameState &state, int depth, PerftCache *cache = nullptr);
+
+/* As above, splitting the work between the threads of the pool; the cache is shared */
+long long perft(GameState const &state, int depth, PerftCache *cache, ThreadPool &threads);
+
+/* Count leaf nodes at depth below each legal move */
+std::vector<std::tuple<Move, long long>> divide(GameState const &state, int depth, PerftCache *cache = nullptr);
+std::vector<std::tuple<Move, long long>> divide(GameState const &state, int depth, PerftCache *cache, ThreadPool &threads);
+
+/* Run perft on each test case, writing a PASS/FAIL line with timings for each to log */
+std::vector<TestResult> runTests(std::vector<TestCase> const &testcases, std::ostream &log);
+
+/* Run the built in test positions */
+std::vector<TestResult> test(std::ostream &log);
+
+/**
+ * Read test cases in the EPD perft format, "<fen> ;D1 <count> ;D2 <count> ..."
+ * Each position is tested at its deepest listed depth not exceeding maxDepth
+ * Positions without such a depth are skipped
+ * Malformed depth fields are skipped, with a SKIP line written to log
+ */
+std::vector<TestCase> readEpd(std::istream &input, int maxDepth, std::ostream &log);
+
+void writeJson(std::vector<TestResult> const &results, std::ostream &output);
+void writeCsv(std::vector<TestResult> const &results, std::ostream &output);
 
 } // namespace Perft
 
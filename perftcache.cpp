@@ -0,0 +1,32 @@
+#include "perftcache.h"
+
+PerftCache::PerftCache(std::size_t megabytes) {
+    const std::size_t maxEntries = (megabytes * 1024 * 1024) / sizeof(Entry);
+    std::size_t count = 1;
+    while (count * 2 <= maxEntries) {
+        count *= 2;
+    }
+    entries = std::vector<Entry>(count);
+    indexMask = count - 1;
+}
+
+bool PerftCache::probe(std::uint64_t key, int depth, long long &nodes) const {
+    // Mix the depth into the index so that depths of one position don't collide
+    Entry const &entry = entries[(key + depth) & indexMask];
+    const std::uint64_t data = entry.data.load(std::memory_order_relaxed);
+    const std::uint64_t check = entry.check.load(std::memory_order_relaxed);
+    // Empty entries have depth zero, which is never probed
+    if ((check ^ data) == key && (data & 0xFF) == static_cast<std::uint64_t>(depth)) {
+        nodes = static_cast<long long>(data >> 8);
+        return true;
+    }
+
+    return false;
+}
+
+void PerftCache::store(std::uint64_t key, int depth, long long nodes) {
+    Entry &entry = entries[(key + depth) & indexMask];
+    const std::uint64_t data = (static_cast<std::uint64_t>(nodes) << 8) | static_cast<std::uint64_t>(depth);
+    entry.check.store(key ^ data, std::memory_order_relaxed);
+    entry.data.store(data, std::memory_order_relaxed);
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+/*
+ * Hash table of perft results, so that subtrees reached through different
+ * move orders are only counted once
+ * Direct mapped and always replacing: a lost entry only costs a recount
+ * Safe to share between threads without locking. Each entry stores its key
+ * XORed with its data, so an entry torn by a concurrent write fails the key
+ * check instead of returning a wrong count
+ */
+
+#ifndef PERFTCACHE_H
+#define PERFTCACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class PerftCache {
+private:
+    struct Entry {
+        std::atomic<std::uint64_t> check; // key ^ data
+        std::atomic<std::uint64_t> data; // Node count in the top 56 bits, depth in the low 8
+
+        Entry() : check(0), data(0) {}
+    };
+
+    std::vector<Entry> entries;
+    std::uint64_t indexMask;
+
+public:
+    explicit PerftCache(std::size_t megabytes);
+
+    /* Set nodes to the count for key at depth, returning false if it is not stored */
+    bool probe(std::uint64_t key, int depth, long long &nodes) const;
+    void store(std::uint64_t key, int depth, long long nodes);
+};
+
+#endif
\ No newline at end of file
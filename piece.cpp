@@ -81,10 +81,6 @@ int Piece::get(Side s, int pieceType) {
     return pieceType * sideMultiplier;
 }
 
-int Piece::getType(int piece) {
-    return std::abs(piece);
-}
-
 Side Piece::getSide(int piece) {
     if (piece > 0) {
         return Side::White;
@@ -27,7 +27,9 @@ public:
     static bool isSide(int piece, Side);
 
     /* Get piece type of piece */
-    static int getType(int piece);
+    static int getType(int piece) {
+        return (piece < 0) ? -piece : piece;
+    }
 
     static Side getSide(int piece);
 };
@@ -0,0 +1,62 @@
+#include "psqt.h"
+
+#include "piecetype.h"
+
+#include <cstdint>
+
+namespace {
+
+constexpr std::uint64_t center6by6 = 35604928818740736ULL;
+constexpr std::uint64_t center4by4 = 66229406269440ULL;
+
+// Indexed by piece type
+constexpr int midgameValues[7] = { 0, 100, 300, 300, 500, 1000, 0 };
+constexpr int endgameValues[7] = { 0, 110, 290, 310, 520, 1000, 0 };
+
+/* Score of a white piece of pieceType on square */
+constexpr Psqt::Score getWhiteScore(int pieceType, int square) {
+    const int in6by6 = (center6by6 >> square) & 1;
+    const int in4by4 = (center4by4 >> square) & 1;
+    const int row = square / 8; // From white's side, 0 to 7
+    // Every piece is worth more close to the center
+    const int position = 2 * in6by6 + in4by4;
+    Psqt::Score score = { midgameValues[pieceType] + position, endgameValues[pieceType] + position };
+    switch (pieceType) {
+        case PieceType::Pawn:
+            // Pawns are worth more as they near promotion, once they can't be stopped by pieces
+            score.endgame += 8 * (row - 1);
+            break;
+        case PieceType::Knight:
+            score += { 5 * in6by6 + 10 * in4by4, 5 * in6by6 + 10 * in4by4 };
+            break;
+        case PieceType::Bishop:
+            score += { 8 * in6by6 + 8 * in4by4, 8 * in6by6 + 8 * in4by4 };
+            break;
+        case PieceType::King:
+            // The king hides in the midgame, and is needed in the center in the endgame
+            score += { -5 * in6by6 - 10 * in4by4, 10 * in6by6 + 15 * in4by4 };
+            break;
+    }
+    return score;
+}
+
+constexpr Psqt::Tables makeTables() {
+    Psqt::Tables tables {};
+    for (int pieceType = PieceType::Pawn; pieceType <= PieceType::King; ++pieceType) {
+        for (int square = 0; square < 64; ++square) {
+            const Psqt::Score score = getWhiteScore(pieceType, square);
+            tables.pieces[pieceType + 6][square] = score;
+            // Black's tables are white's flipped vertically
+            tables.pieces[-pieceType + 6][square ^ 56] = { -score.midgame, -score.endgame };
+        }
+    }
+    tables.phases[PieceType::Knight] = 1;
+    tables.phases[PieceType::Bishop] = 1;
+    tables.phases[PieceType::Rook] = 2;
+    tables.phases[PieceType::Queen] = 4;
+    return tables;
+}
+
+}
+
+constexpr Psqt::Tables Psqt::tables = makeTables();
\ No newline at end of file
@@ -0,0 +1,60 @@
+/*
+ * Piece-square tables
+ * Every piece on every square is worth a midgame and an endgame score,
+ * including its material value. The board keeps the sums of these, white
+ * minus black, up to date as pieces are added, moved and removed, along with
+ * the game phase: the non-pawn material left, which blends the two scores
+ * The tables are generated at compile time
+ */
+
+#ifndef PSQT_H
+#define PSQT_H
+
+namespace Psqt {
+
+struct Score {
+    int midgame;
+    int endgame;
+
+    constexpr Score &operator+=(Score const &other) {
+        midgame += other.midgame;
+        endgame += other.endgame;
+        return *this;
+    }
+
+    constexpr Score &operator-=(Score const &other) {
+        midgame -= other.midgame;
+        endgame -= other.endgame;
+        return *this;
+    }
+};
+
+// Phase with all pieces but the pawns on the board
+constexpr int maxPhase = 24;
+
+struct Tables {
+    Score pieces[13][64]; // Indexed by piece + 6, with black scores negated
+    int phases[7]; // Indexed by piece type
+};
+
+extern const Tables tables;
+
+inline Score get(int piece, int square) {
+    return tables.pieces[piece + 6][square];
+}
+
+inline int getPhase(int pieceType) {
+    return tables.phases[pieceType];
+}
+
+/* Blend a score by phase, from the endgame at 0 to the midgame at maxPhase */
+inline int taper(Score score, int phase) {
+    if (phase > maxPhase) {
+        phase = maxPhase; // Possible after promotions
+    }
+    return (score.midgame * phase + score.endgame * (maxPhase - phase)) / maxPhase;
+}
+
+} // namespace Psqt
+
+#endif
\ No newline at end of file
@@ -7,9 +7,7 @@ typedef std::uint64_t Bitboard;
 namespace {
 
 constexpr Bitboard notAColumn = 9187201950435737471ULL;
-constexpr Bitboard notABColumn = 4557430888798830399ULL;
 constexpr Bitboard notHColumn = 18374403900871474942ULL;
-constexpr Bitboard notGHColumn = 18229723555195321596ULL;
 
 }
 
@@ -95,33 +93,6 @@ std::tuple<int, int> Square::diff(int a, int b) {
     return std::tuple<int, int>(x2 - x1, y2 - y1);
 }
 
-// Assume straight line between A and B exists
-std::vector<int> Square::fromAtoBInclusive(int a, int b) {
-    std::vector<int> results;
-    if (a == b) {
-        return results;
-    }
-    int x, y;
-    std::tie(x, y) = Square::diff(b, a);
-    if (x > 1) {
-        x = 1;
-    } else if (x < -1) {
-        x = -1;
-    }
-    if (y > 1) {
-        y = 1;
-    } else if (y < -1) {
-        y = -1;
-    }
-    int current = b;
-    while (current != a) {
-        results.emplace_back(current);
-        current += y * 8 + x;
-    }
-
-    return results;
-}
-
 int Square::getInDirection(int square, int x, int y) {
     const int newX = Square::getColumn(square) + x;
     const int newY = Square::getRow(square) + y;
@@ -168,47 +139,4 @@ bool Square::inLine(int a, int b) {
 std::string Square::toString(int square) {
     char col = Square::getColumn(square) + 'a';
     return std::string(1, col) + std::to_string(Square::getRow(square));
-}
-
-/*
- * TODO: consider fallbacks
- */
-int Square::getSetBit(Bitboard b) {
-    return __builtin_ctzll(b);
-}
-
-int Square::getBitCount(Bitboard b) {
-    int counter = 0;
-    while (b) {
-        b = b & (b - 1);
-        ++counter;
-    }
-
-    return counter;
-}
-
-Bitboard Square::getMask(int square) {
-    return 1ULL << square;
-}
-
-Bitboard Square::getKnightAttacks(Bitboard square) {
-    return ((square >> 6 & notGHColumn) |
-            (square >> 10 & notABColumn) |
-            (square >> 15 & notHColumn) |
-            (square >> 17 & notAColumn) |
-            (square << 6 & notABColumn) |
-            (square << 10 & notGHColumn) |
-            (square << 15 & notAColumn) |
-            (square << 17 & notHColumn));
-}
-
-Bitboard Square::getKingAttacks(Bitboard square) {
-    return ((square >> 9 & notAColumn) |
-            (square >> 8) |
-            (square >> 7 & notHColumn) |
-            (square >> 1 & notAColumn) |
-            (square << 1 & notHColumn) |
-            (square << 7 & notAColumn) |
-            (square << 8) |
-            (square << 9 & notHColumn));
 }
\ No newline at end of file
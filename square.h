@@ -6,11 +6,11 @@
 #define SQUARE_H
 
 #include "column.h"
+#include "cpu.h"
 #include "direction.h"
 
 #include <string>
 #include <tuple>
-#include <vector>
 
 typedef std::uint64_t Bitboard;
 
@@ -27,7 +27,6 @@ int getRowB(int squareIndex);
 /* Get column of square (0-63) */
 int getColumn(int squareIndex);
 
-std::vector<int> fromAtoBInclusive(int a, int b);
 bool inLine(int a, int );
 
 /* Returns -1 if square is out of range */
@@ -39,15 +38,21 @@ int getInYDirection(int square, int y);
 
 std::string toString(int square);
 
-int getSetBit(Bitboard b);
-
-int getBitCount(Bitboard b);
-
-Bitboard getMask(int square);
+/*
+ * Index of the least significant set bit; b must be non-zero
+ * GCC emits rep bsf, which runs as TZCNT on processors supporting BMI1
+ */
+inline int getSetBit(Bitboard b) {
+    return __builtin_ctzll(b);
+}
 
-Bitboard getKnightAttacks(Bitboard square);
+inline int getBitCount(Bitboard b) {
+    return Cpu::popcount(b);
+}
 
-Bitboard getKingAttacks(Bitboard square);
+inline Bitboard getMask(int square) {
+    return 1ULL << square;
+}
 
 } // namespace Square
 
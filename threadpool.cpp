@@ -0,0 +1,69 @@
+#include "threadpool.h"
+
+ThreadPool::ThreadPool(int size) : generation(0), running(0), shuttingDown(false) {
+    resize(size);
+}
+
+ThreadPool::~ThreadPool() {
+    shutDown();
+}
+
+int ThreadPool::size() const {
+    return workers.size() + 1;
+}
+
+void ThreadPool::resize(int size) {
+    shutDown();
+    shuttingDown = false;
+    for (int index = 1; index < size; ++index) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, index, generation);
+    }
+}
+
+void ThreadPool::shutDown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        shuttingDown = true;
+    }
+    wakeUp.notify_all();
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+}
+
+void ThreadPool::start(std::function<void(int)> const &newJob) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = newJob;
+        running = workers.size();
+        ++generation;
+    }
+    wakeUp.notify_all();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [this]() { return running == 0; });
+}
+
+void ThreadPool::workerLoop(int index, unsigned long long lastGeneration) {
+    while (true) {
+        std::function<void(int)> currentJob;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeUp.wait(lock, [&]() { return shuttingDown || generation != lastGeneration; });
+            if (shuttingDown) {
+                return;
+            }
+            lastGeneration = generation;
+            currentJob = job;
+        }
+        currentJob(index);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --running;
+        }
+        finished.notify_all();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+/*
+ * Worker threads kept alive between searches, so that starting a search does
+ * not pay for creating threads
+ * The calling thread counts as thread 0; the pool owns threads 1 to size - 1
+ */
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wakeUp; // Signalled when a job is started or the pool shuts down
+    std::condition_variable finished; // Signalled when a worker finishes its job
+    std::function<void(int)> job;
+    unsigned long long generation; // Incremented for every job started
+    int running; // Workers that have not finished the current job
+    bool shuttingDown;
+
+    /* lastGeneration is the last job the worker should not run */
+    void workerLoop(int index, unsigned long long lastGeneration);
+    void shutDown();
+
+public:
+    explicit ThreadPool(int size = 1);
+    ~ThreadPool();
+    ThreadPool(ThreadPool const &) = delete;
+    ThreadPool &operator=(ThreadPool const &) = delete;
+
+    /* Total number of threads, including the calling thread */
+    int size() const;
+
+    /* Change the number of threads; must not be called while a job is running */
+    void resize(int size);
+
+    /* Run job(index) on each worker thread, returning without waiting */
+    void start(std::function<void(int)> const &job);
+
+    /* Wait for all workers to finish the current job */
+    void wait();
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,82 @@
+#include "timemanager.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace {
+
+// Each iteration is assumed to take this many times as long as the last
+constexpr long long branchingFactor = 3;
+
+}
+
+SearchLimits SearchLimits::fromUciString(std::string const &arguments) {
+    SearchLimits limits;
+    std::istringstream stream(arguments);
+    std::string token;
+    while (stream >> token) {
+        if (token == "infinite") {
+            limits.infinite = true;
+        } else if (token == "depth") {
+            stream >> limits.depth;
+        } else if (token == "nodes") {
+            stream >> limits.nodes;
+        } else if (token == "movetime") {
+            stream >> limits.moveTime;
+        } else if (token == "wtime") {
+            stream >> limits.time[0];
+        } else if (token == "btime") {
+            stream >> limits.time[1];
+        } else if (token == "winc") {
+            stream >> limits.increment[0];
+        } else if (token == "binc") {
+            stream >> limits.increment[1];
+        } else if (token == "movestogo") {
+            stream >> limits.movesToGo;
+        }
+    }
+    if (!limits.infinite && !limits.isTimed() && limits.depth == 0 && limits.nodes == 0) {
+        limits.depth = defaultDepth;
+    }
+    limits.depth = std::min(limits.depth == 0 ? maxDepth : limits.depth, static_cast<int>(maxDepth));
+
+    return limits;
+}
+
+bool SearchLimits::isTimed() const {
+    return moveTime > 0 || time[0] > 0 || time[1] > 0;
+}
+
+TimeManager::TimeManager(SearchLimits const &limits, Side side) :
+        startTime(std::chrono::steady_clock::now()), timed(!limits.infinite && limits.isTimed()), softLimit(0), hardLimit(0) {
+    if (!timed) {
+        return;
+    }
+    if (limits.moveTime > 0) {
+        softLimit = hardLimit = std::max(1, limits.moveTime - moveOverhead);
+        return;
+    }
+    const int index = side == Side::White ? 0 : 1;
+    const long long increment = limits.increment[index];
+    const long long available = std::max(1LL, limits.time[index] - static_cast<long long>(moveOverhead));
+    const int movesToGo = limits.movesToGo > 0 ? std::min(limits.movesToGo, defaultMovesToGo) : defaultMovesToGo;
+    // Never plan to use more than three quarters of the clock on one move
+    hardLimit = std::max(1LL, std::min(available * 3 / 4, (available / movesToGo + increment) * 4));
+    softLimit = std::max(1LL, std::min(hardLimit, available / movesToGo + increment * 3 / 4));
+}
+
+long long TimeManager::getElapsed() const {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+bool TimeManager::canStartIteration(long long lastIterationTime) const {
+    if (!timed) {
+        return true;
+    }
+    const long long elapsed = getElapsed();
+    return elapsed < softLimit && elapsed + lastIterationTime * branchingFactor < hardLimit;
+}
+
+bool TimeManager::isHardLimitReached() const {
+    return timed && getElapsed() >= hardLimit;
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+/*
+ * Limits of a search, as given by the UCI go command, and the time budget
+ * derived from them
+ * The soft limit is the time after which no new iteration is started; the
+ * hard limit is the time at which a running iteration is abandoned
+ */
+
+#ifndef TIMEMANAGER_H
+#define TIMEMANAGER_H
+
+#include "side.h"
+
+#include <chrono>
+#include <string>
+
+struct SearchLimits {
+    static constexpr int maxDepth = 64;
+    // Used when go gives no limit at all
+    static constexpr int defaultDepth = 4;
+
+    int depth = 0; // 0 if not given, as are the other limits
+    long long nodes = 0;
+    int moveTime = 0; // Milliseconds
+    int time[2] = { 0, 0 }; // Remaining clock time, indexed by side, white first
+    int increment[2] = { 0, 0 };
+    int movesToGo = 0;
+    bool infinite = false;
+
+    /* Parses the arguments following "go" */
+    static SearchLimits fromUciString(std::string const &);
+
+    bool isTimed() const;
+};
+
+class TimeManager {
+private:
+    // Kept in reserve for communication with the GUI
+    static constexpr int moveOverhead = 20;
+    // Assumed moves remaining when the time control doesn't say
+    static constexpr int defaultMovesToGo = 30;
+
+    std::chrono::steady_clock::time_point startTime;
+    bool timed;
+    long long softLimit;
+    long long hardLimit;
+
+public:
+    TimeManager(SearchLimits const &limits, Side side);
+
+    long long getElapsed() const;
+
+    /**
+     * Whether an iteration expected to take about as long as the previous
+     * one times the branching factor can finish within the hard limit
+     */
+    bool canStartIteration(long long lastIterationTime) const;
+
+    bool isHardLimitReached() const;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include "transpositiontable.h"
+
+TranspositionTable::TranspositionTable(std::size_t megabytes) : age(0) {
+    resize(megabytes);
+}
+
+void TranspositionTable::resize(std::size_t megabytes) {
+    const std::size_t maxBuckets = (megabytes * 1024 * 1024) / sizeof(Bucket);
+    std::size_t count = 1;
+    while (count * 2 <= maxBuckets) {
+        count *= 2;
+    }
+    buckets = std::vector<Bucket>(count);
+    indexMask = count - 1;
+    age = 0;
+}
+
+void TranspositionTable::clear() {
+    for (Bucket &bucket : buckets) {
+        for (Slot &slot : bucket.slots) {
+            slot.check.store(0, std::memory_order_relaxed);
+            slot.data.store(0, std::memory_order_relaxed);
+        }
+    }
+    age = 0;
+}
+
+void TranspositionTable::newSearch() {
+    ++age;
+}
+
+std::uint64_t TranspositionTable::pack(TTEntry const &entry) {
+    const std::uint64_t move = entry.bestMove.getOrigin() |
+                               (entry.bestMove.getDestination() << 6) |
+                               (entry.bestMove.getFlags() << 12);
+    return move |
+           (static_cast<std::uint64_t>(static_cast<std::uint16_t>(entry.score)) << 16) |
+           (static_cast<std::uint64_t>(static_cast<std::uint8_t>(entry.depth)) << 32) |
+           (static_cast<std::uint64_t>(entry.bound) << 40) |
+           (static_cast<std::uint64_t>(entry.age) << 48);
+}
+
+TTEntry TranspositionTable::unpack(std::uint64_t key, std::uint64_t data) {
+    TTEntry entry;
+    entry.key = key;
+    entry.bestMove = Move(data & 0x3F, (data >> 6) & 0x3F, (data >> 12) & 0xF);
+    entry.score = static_cast<std::int16_t>(data >> 16);
+    entry.depth = static_cast<std::int8_t>(data >> 32);
+    entry.bound = static_cast<std::uint8_t>(data >> 40);
+    entry.age = static_cast<std::uint8_t>(data >> 48);
+    return entry;
+}
+
+bool TranspositionTable::probe(std::uint64_t key, TTEntry &entry) const {
+    for (Slot const &slot : getBucket(key).slots) {
+        const std::uint64_t data = slot.data.load(std::memory_order_relaxed);
+        const std::uint64_t check = slot.check.load(std::memory_order_relaxed);
+        if ((check ^ data) == key && data != 0) {
+            entry = unpack(key, data);
+            return entry.bound != Bound::None;
+        }
+    }
+
+    return false;
+}
+
+void TranspositionTable::store(std::uint64_t key, int depth, int bound, int score, Move bestMove) {
+    Bucket &bucket = getBucket(key);
+    const std::uint8_t currentAge = age;
+    Slot *replace = &bucket.slots[0];
+    TTEntry replaced = unpack(0, 0);
+    int replaceWorth = 0x7FFFFFFF;
+    for (Slot &slot : bucket.slots) {
+        const std::uint64_t data = slot.data.load(std::memory_order_relaxed);
+        const std::uint64_t slotKey = slot.check.load(std::memory_order_relaxed) ^ data;
+        const TTEntry candidate = unpack(slotKey, data);
+        if (slotKey == key || candidate.bound == Bound::None) {
+            replace = &slot;
+            replaced = candidate;
+            break;
+        }
+        // Each search of age counts as much as 8 plies of depth
+        const int worth = candidate.depth - 8 * static_cast<std::uint8_t>(currentAge - candidate.age);
+        if (worth < replaceWorth) {
+            replace = &slot;
+            replaced = candidate;
+            replaceWorth = worth;
+        }
+    }
+    if (replaced.key == key && replaced.bound != Bound::None) {
+        // Keep a deeper result of the same position from this search
+        if (replaced.age == currentAge && replaced.depth > depth && bound != Bound::Exact) {
+            return;
+        }
+        if (bestMove.isNone()) {
+            bestMove = replaced.bestMove;
+        }
+    }
+    TTEntry entry;
+    entry.bestMove = bestMove;
+    entry.score = static_cast<std::int16_t>(score);
+    entry.depth = static_cast<std::int8_t>(depth);
+    entry.bound = static_cast<std::uint8_t>(bound);
+    entry.age = currentAge;
+    const std::uint64_t data = pack(entry);
+    replace->check.store(key ^ data, std::memory_order_relaxed);
+    replace->data.store(data, std::memory_order_relaxed);
+}
\ No newline at end of file
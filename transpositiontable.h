@@ -0,0 +1,87 @@
+/*
+ * Fixed-size hash table of search results, indexed by Zobrist key
+ * Entries are grouped in buckets of four that fill one cache line. When a
+ * bucket is full, the shallowest entry from the oldest search is replaced, so
+ * deep results from earlier moves of the same game survive
+ * The table is shared by all search threads without locking. Each slot holds
+ * its packed data and the key XORed with that data, so a slot torn by two
+ * threads writing at once fails the key check and is treated as a miss
+ */
+
+#ifndef TRANSPOSITIONTABLE_H
+#define TRANSPOSITIONTABLE_H
+
+#include "move.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* How a stored score relates to the true score of the position */
+class Bound {
+public:
+    static constexpr int None = 0;
+    static constexpr int Exact = 1;
+    static constexpr int Lower = 2; // Failed high, true score is at least this
+    static constexpr int Upper = 3; // Failed low, true score is at most this
+};
+
+struct TTEntry {
+    std::uint64_t key;
+    Move bestMove;
+    std::int16_t score; // Relative to the side to play
+    std::int8_t depth;
+    std::uint8_t bound;
+    std::uint8_t age; // Search the entry was written in
+};
+
+class TranspositionTable {
+private:
+    static constexpr int bucketSize = 4;
+
+    struct Slot {
+        std::atomic<std::uint64_t> check; // key ^ data
+        // Best move in bits 0-15, score 16-31, depth 32-39, bound 40-47, age 48-55
+        std::atomic<std::uint64_t> data;
+
+        Slot() : check(0), data(0) {}
+    };
+
+    struct alignas(64) Bucket {
+        Slot slots[bucketSize];
+    };
+
+    static std::uint64_t pack(TTEntry const &entry);
+    static TTEntry unpack(std::uint64_t key, std::uint64_t data);
+
+    std::vector<Bucket> buckets;
+    std::uint64_t indexMask;
+    std::atomic<std::uint8_t> age;
+
+    Bucket &getBucket(std::uint64_t key) {
+        return buckets[key & indexMask];
+    }
+
+    Bucket const &getBucket(std::uint64_t key) const {
+        return buckets[key & indexMask];
+    }
+
+public:
+    static constexpr std::size_t defaultMegabytes = 16;
+
+    explicit TranspositionTable(std::size_t megabytes = defaultMegabytes);
+
+    /* Resize to the largest power of two number of buckets that fits, clearing all entries */
+    void resize(std::size_t megabytes);
+    void clear();
+
+    /* Called at the start of each search, so that older entries are replaced first */
+    void newSearch();
+
+    /* Copy the entry for key into entry, returning false if there is none */
+    bool probe(std::uint64_t key, TTEntry &entry) const;
+    void store(std::uint64_t key, int depth, int bound, int score, Move bestMove);
+};
+
+#endif
\ No newline at end of file
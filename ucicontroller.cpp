@@ -1,15 +1,41 @@
 #include "ucicontroller.h"
 
+#include "cpu.h"
 #include "engine.h"
 
+#include <algorithm>
+#include <exception>
 #include <fstream>
 #include <iostream>
 
 const std::string LOGFILE = "debug.log";
 
-UciController::UciController() {}
+namespace {
+
+static constexpr int maxHashMegabytes = 4096;
+static constexpr int maxThreads = 256;
+
+/* Read a spin option value into result, clamped to [min, max]; returns false if it is not a number */
+bool parseSpinValue(std::string const &value, int min, int max, int &result) {
+    try {
+        result = std::stoi(value);
+    } catch (std::exception const &) {
+        return false;
+    }
+    result = std::max(min, std::min(result, max));
+    return true;
+}
+
+}
+
+UciController::UciController() : pawnTables(1), stop(false), stopRequested(false) {}
+
+UciController::~UciController() {
+    stopSearch();
+}
 
 void UciController::send(std::string const &msg) {
+    std::lock_guard<std::mutex> lock(outputMutex);
     std::ofstream outputFile(LOGFILE, std::ios::app);
     outputFile << "-> " << msg << std::endl;
     std::cout << msg << std::endl;
@@ -19,6 +45,9 @@ void UciController::send(std::string const &msg) {
 void UciController::init() {
     send("id name lrdwhyt/chess");
     send("id author Lrdwhyt");
+    send("info string Bit manipulation backend: " + Cpu::getBackendName());
+    send("option name Hash type spin default " + std::to_string(TranspositionTable::defaultMegabytes) + " min 1 max " + std::to_string(maxHashMegabytes));
+    send("option name Threads type spin default 1 min 1 max " + std::to_string(maxThreads));
     send("uciok");
     waitForInput();
 }
@@ -26,36 +55,98 @@ void UciController::init() {
 void UciController::waitForInput() {
     std::string input;
     while (std::getline(std::cin, input)) {
-        std::ofstream outputFile(LOGFILE, std::ios::app);
-        outputFile << input << std::endl;
-        outputFile.close();
+        {
+            std::lock_guard<std::mutex> lock(outputMutex);
+            std::ofstream outputFile(LOGFILE, std::ios::app);
+            outputFile << input << std::endl;
+        }
         if (!handleIn(input)) {
             break;
         }
     }
 }
 
+/*
+ * Commands other than isready are not expected during a search; any that
+ * change the engine's state stop the search first
+ */
 bool UciController::handleIn(std::string const &input) {
     if (input == "ucinewgame") {
+        stopSearch();
         initialisedGame = false;
+        transpositionTable.clear();
     } else if (input == "isready") {
         send("readyok");
     } else if (input == "quit") {
+        stopSearch();
         return false;
     } else if (input == "stop") {
-        // TODO: interrupt calculation and return best move
+        stopSearch();
+    } else if (input.length() >= 9 && input.substr(0, 9) == "setoption") {
+        stopSearch();
+        setOption(input.substr(10));
     } else if (input.length() >= 8 && input.substr(0, 8) == "position") {
+        stopSearch();
         updatePosition(input.substr(9));
     } else if (input.length() >= 2 && input.substr(0, 2) == "go") {
-        send("bestmove " + getBestMove().toString());
+        stopSearch();
+        startSearch(SearchLimits::fromUciString(input.substr(2)));
     }
     return true;
 }
 
+/* A position with an unreadable or illegal move is reported and ignored */
 void UciController::updatePosition(std::string const &position) {
-    gamestate = GameState::loadFromUciString(position);
+    try {
+        gamestate = GameState::loadFromUciString(position);
+    } catch (std::exception const &err) {
+        send(std::string("info string Ignoring position: ") + err.what());
+    }
+}
+
+/* Handles "name <name> value <value>"; values that are not numbers are ignored */
+void UciController::setOption(std::string const &option) {
+    const std::size_t valueIndex = option.find(" value ");
+    if (option.substr(0, 5) != "name " || valueIndex == std::string::npos) {
+        return;
+    }
+    const std::string name = option.substr(5, valueIndex - 5);
+    const std::string value = option.substr(valueIndex + 7);
+    int number;
+    if (name == "Hash" && parseSpinValue(value, 1, maxHashMegabytes, number)) {
+        transpositionTable.resize(number);
+    } else if (name == "Threads" && parseSpinValue(value, 1, maxThreads, number)) {
+        threads.resize(number);
+        pawnTables.resize(number);
+    }
 }
 
-Move UciController::getBestMove() const {
-    return Engine::alphaBetaPrune(gamestate, 4);
+void UciController::startSearch(SearchLimits const &limits) {
+    // Cleared here rather than on the search thread, so that a stop arriving
+    // before the search starts is not lost
+    stop = false;
+    stopRequested = false;
+    searchThread = std::thread([this, limits]() {
+        const Move bestMove = Engine::search(gamestate, limits, transpositionTable, threads, pawnTables, stop,
+            [this](std::string const &info) { send(info); });
+        if (limits.infinite) {
+            // An infinite search may only report its move once told to stop
+            std::unique_lock<std::mutex> lock(stopMutex);
+            stopped.wait(lock, [this]() { return stopRequested; });
+        }
+        // UCI's null move, sent when there is no legal move to play
+        send("bestmove " + (bestMove.isNone() ? std::string("0000") : bestMove.toString()));
+    });
+}
+
+void UciController::stopSearch() {
+    {
+        std::lock_guard<std::mutex> lock(stopMutex);
+        stopRequested = true;
+    }
+    stop = true;
+    stopped.notify_all();
+    if (searchThread.joinable()) {
+        searchThread.join();
+    }
 }
\ No newline at end of file
@@ -2,21 +2,45 @@
 #define UCICONTROLLER_H
 
 #include "gamestate.h"
+#include "threadpool.h"
+#include "timemanager.h"
+#include "transpositiontable.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 class UciController {
 private:
     GameState gamestate;
     bool initialisedGame;
     std::string lastMovesString;
-    Move getBestMove() const;
+    // Kept across searches so that results carry over between moves
+    TranspositionTable transpositionTable;
+    ThreadPool threads; // Kept alive between searches
+    std::vector<PawnTable> pawnTables; // One per search thread, kept across searches
+    // Searches run on their own thread so that input is handled meanwhile
+    std::thread searchThread;
+    std::atomic<bool> stop; // Polled by the search, which also sets it when done
+    std::mutex stopMutex;
+    bool stopRequested; // Whether stop was sent, guarded by stopMutex
+    std::condition_variable stopped; // Signalled when stopRequested is set
+    std::mutex outputMutex;
+    void startSearch(SearchLimits const &);
+
+    /* Stop any running search, which then sends its best move, and wait for it */
+    void stopSearch();
+    void setOption(std::string const &);
     void waitForInput();
     bool handleIn(std::string const &);
     void send(std::string const &message);
 
 public:
     UciController();
+    ~UciController();
     void init();
     void updatePosition(std::string const &);
 };
@@ -0,0 +1,36 @@
+#include "zobrist.h"
+
+namespace {
+
+/* SplitMix64, which is good enough for hash keys and simple to run constexpr */
+constexpr std::uint64_t nextRandom(std::uint64_t &state) {
+    state += 0x9E3779B97F4A7C15ULL;
+    std::uint64_t z = state;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+constexpr Zobrist::Keys makeKeys() {
+    Zobrist::Keys keys {};
+    std::uint64_t state = 0x2545F4914F6CDD1DULL;
+    for (int piece = 0; piece < 13; ++piece) {
+        for (int square = 0; square < 64; ++square) {
+            // Piece::None never sits on a square, so leave its keys at zero
+            keys.pieces[piece][square] = (piece == 6) ? 0 : nextRandom(state);
+        }
+    }
+    keys.side = nextRandom(state);
+    // No castling rights hash to zero
+    for (int rights = 1; rights < 16; ++rights) {
+        keys.castlingRights[rights] = nextRandom(state);
+    }
+    for (int column = 0; column < 8; ++column) {
+        keys.enPassantColumns[column] = nextRandom(state);
+    }
+    return keys;
+}
+
+}
+
+constexpr Zobrist::Keys Zobrist::keys = makeKeys();
\ No newline at end of file
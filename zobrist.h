@@ -0,0 +1,44 @@
+/*
+ * Zobrist hashing
+ * A position's key is the XOR of a random number for each piece on each
+ * square, the side to play, the castling rights and the en passant column, so
+ * that making a move only takes a few XORs to update it
+ * The random numbers are generated at compile time
+ */
+
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include <cstdint>
+
+namespace Zobrist {
+
+struct Keys {
+    std::uint64_t pieces[13][64]; // Indexed by piece + 6, so black pieces come first
+    std::uint64_t side; // Included when black is to play
+    std::uint64_t castlingRights[16];
+    std::uint64_t enPassantColumns[8];
+};
+
+extern const Keys keys;
+
+inline std::uint64_t getPieceKey(int piece, int square) {
+    return keys.pieces[piece + 6][square];
+}
+
+inline std::uint64_t getSideKey() {
+    return keys.side;
+}
+
+inline std::uint64_t getCastlingKey(int castlingRights) {
+    return keys.castlingRights[castlingRights];
+}
+
+/* Key for an en passant square, which only depends on its column */
+inline std::uint64_t getEnPassantKey(int square) {
+    return keys.enPassantColumns[square % 8];
+}
+
+} // namespace Zobrist
+
+#endif
\ No newline at end of file